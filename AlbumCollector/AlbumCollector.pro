@@ -1,20 +1,24 @@
-QT       += core gui network widgets
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+# core:  GUI-free data model, storage, sorting, indexes and Spotify client
+# app:   the Qt Widgets application
+# bench: performance benchmarks against core
+# libgen: synthetic library generator for scale testing
+# libexport: streams a library out as JSON Lines, CSV or an HTML gallery
+# mockspotify: local Spotify API stand-in with latency/bandwidth/error controls
+SUBDIRS += \
+    core \
+    app \
+    bench \
+    libgen \
+    libexport \
+    mockspotify
 
-CONFIG += c++11
-
-SOURCES += \
-    main.cc \
-    mainwindow.cpp
-
-HEADERS += \
-    mainwindow.h \
-    SpotifyClient.h
-
-LIBS += -lcurl
-
-INCLUDEPATH += /opt/homebrew/Cellar/nlohmann-json/3.11.3/include 
-
-RESOURCES += \
-    resources.qrc 
\ No newline at end of file
+app.file = app.pro
+app.depends = core
+bench.depends = core
+libgen.subdir = tools/libgen
+libgen.depends = core
+libexport.subdir = tools/libexport
+libexport.depends = core
+mockspotify.subdir = tools/mockspotify
@@ -0,0 +1,38 @@
+QT       += core gui network widgets concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+
+TARGET = AlbumCollector
+
+SOURCES += \
+    main.cc \
+    mainwindow.cpp \
+    scaletest.cpp \
+    startuptimer.cpp \
+    eventloopmonitor.cpp \
+    themestyle.cpp \
+    thumbnailcache.cpp \
+    thumbnailsidecar.cpp \
+    duplicatesdialog.cpp \
+    libraryimporter.cpp \
+    librarygrid.cpp
+
+HEADERS += \
+    mainwindow.h \
+    scaletest.h \
+    startuptimer.h \
+    eventloopmonitor.h \
+    themestyle.h \
+    thumbnailcache.h \
+    thumbnailsidecar.h \
+    duplicatesdialog.h \
+    libraryimporter.h \
+    librarygrid.h \
+    covertransfer.h
+
+include(core/core.pri)
+
+RESOURCES += \
+    resources.qrc 
@@ -0,0 +1,33 @@
+# Performance benchmarks (Google Benchmark). Run with
+#   ./album_bench --benchmark_format=json --benchmark_out=results.json
+# to get machine-readable results that can be compared across commits.
+# All inputs are recorded responses or deterministic synthetic libraries.
+
+QT       += core gui network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = album_bench
+
+SOURCES += \
+    bench_main.cpp \
+    bench_library_index.cpp \
+    bench_search_parsing.cpp \
+    bench_library_store.cpp \
+    bench_library_sort.cpp \
+    bench_thumbnails.cpp \
+    bench_cover_hash.cpp \
+    bench_transfer.cpp \
+    ../tools/mockspotify/MockSpotifyServer.cpp
+
+HEADERS += \
+    bench_common.h \
+    ../tools/mockspotify/MockSpotifyServer.h
+
+DEFINES += BENCH_DATA_DIR=\\\"$$PWD/data\\\"
+
+include(../core/core.pri)
+
+INCLUDEPATH += ../tools /opt/homebrew/include
+LIBS += -L/opt/homebrew/lib -lbenchmark -lz
@@ -0,0 +1,16 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include "SyntheticCovers.h"
+
+// Recorded API responses live in bench/data (BENCH_DATA_DIR is set by bench.pro)
+inline QByteArray readBenchData(const QString& name)
+{
+    QFile file(QStringLiteral(BENCH_DATA_DIR "/") + name);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+#endif // BENCH_COMMON_H
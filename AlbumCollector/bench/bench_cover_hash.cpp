@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "CoverHash.h"
+
+namespace {
+
+// Random hashes with every tenth one a near copy of its predecessor, like
+// a library where some albums share art across editions
+std::vector<uint64_t> makeHashes(int count)
+{
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> hashes;
+    hashes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        uint64_t hash = rng();
+        if (i > 0 && i % 10 == 0) {
+            hash = hashes.back();
+            for (int flips = int(rng() % 6); flips > 0; --flips) hash ^= uint64_t(1) << (rng() % 64);
+        }
+        hashes.push_back(hash);
+    }
+    return hashes;
+}
+
+// Whole-library duplicate grouping through the multi-index tables
+void BM_DuplicateClusters(benchmark::State& state)
+{
+    const std::vector<uint64_t> hashes = makeHashes(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        DuplicateIndex index;
+        index.reserve(hashes.size());
+        for (uint64_t hash : hashes) index.add(hash);
+        auto groups = index.clusters(static_cast<int>(state.range(1)));
+        benchmark::DoNotOptimize(groups.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Every hash within maxDistance of hash: distances first in a branch-free
+// pass the compiler vectorises, then the few matches
+std::vector<int> scan(const std::vector<uint64_t>& hashes, uint64_t hash, int maxDistance)
+{
+    const size_t count = hashes.size();
+    std::vector<uint8_t> distances(count);
+    for (size_t i = 0; i < count; ++i) {
+        distances[i] = static_cast<uint8_t>(__builtin_popcountll(hashes[i] ^ hash));
+    }
+
+    std::vector<int> matches;
+    for (size_t i = 0; i < count; ++i) {
+        if (distances[i] <= maxDistance) matches.push_back(static_cast<int>(i));
+    }
+    return matches;
+}
+
+// One cover against the whole library by brute force, the baseline the
+// index has to beat
+void BM_DuplicateScan(benchmark::State& state)
+{
+    const std::vector<uint64_t> hashes = makeHashes(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto matches = scan(hashes, hashes[hashes.size() / 2], 6);
+        benchmark::DoNotOptimize(matches.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_DuplicateClusters)
+    ->ArgNames({"covers", "distance"})
+    ->ArgsProduct({{10000, 100000}, {3, 6, 11}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_DuplicateScan)
+    ->ArgNames({"covers"})
+    ->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
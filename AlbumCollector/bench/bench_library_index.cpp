@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <QString>
+#include <map>
+#include "LibraryIndex.h"
+#include "SyntheticLibrary.h"
+
+namespace {
+
+std::vector<Album> makeAlbums(int count)
+{
+    SyntheticLibrary::Options options;
+    options.albumCount = count;
+
+    std::vector<Album> albums;
+    albums.reserve(count);
+    for (const LibraryAlbum& libAlbum : SyntheticLibrary::generate(options)) {
+        albums.push_back(libAlbum.album);
+    }
+
+    // A known album so the typo queries have something to find
+    albums[count / 2] = Album("OK Computer", "Radiohead", "radiohead",
+                              "1997-05-21", "https://i.scdn.co/image/okc");
+    return albums;
+}
+
+LibraryIndex& indexOfSize(int count)
+{
+    static std::map<int, LibraryIndex> indexes;
+    auto it = indexes.find(count);
+    if (it == indexes.end()) {
+        it = indexes.emplace(count, LibraryIndex()).first;
+        for (const Album& album : makeAlbums(count)) it->second.add(album);
+    }
+    return it->second;
+}
+
+void BM_PrefixSearch(benchmark::State& state)
+{
+    LibraryIndex& index = indexOfSize(static_cast<int>(state.range(0)));
+    const QString query = QStringLiteral("radioh");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.search(query));
+    }
+}
+
+void BM_FuzzySearch(benchmark::State& state)
+{
+    LibraryIndex& index = indexOfSize(static_cast<int>(state.range(0)));
+    const QString query = QStringLiteral("radiohed");
+    size_t found = 0;
+    for (auto _ : state) {
+        auto matches = index.fuzzySearch(query);
+        found = matches.size();
+        benchmark::DoNotOptimize(matches);
+    }
+    state.counters["matches"] = static_cast<double>(found);
+}
+
+void BM_FuzzySearchTwoWords(benchmark::State& state)
+{
+    LibraryIndex& index = indexOfSize(static_cast<int>(state.range(0)));
+    const QString query = QStringLiteral("radiohed ok compter");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.fuzzySearch(query));
+    }
+}
+
+void BM_BuildIndex(benchmark::State& state)
+{
+    const std::vector<Album> albums = makeAlbums(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        LibraryIndex index;
+        for (const Album& album : albums) index.add(album);
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_PrefixSearch)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FuzzySearch)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FuzzySearchTwoWords)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildIndex)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
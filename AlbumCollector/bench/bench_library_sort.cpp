@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+#include "LibrarySort.h"
+#include "SyntheticLibrary.h"
+
+namespace {
+
+// Every iteration sorts a fresh copy of the same shuffled library
+void BM_SortLibrary(benchmark::State& state)
+{
+    SyntheticLibrary::Options options;
+    options.albumCount = static_cast<int>(state.range(1));
+    const QVector<LibraryAlbum> library = SyntheticLibrary::generate(options);
+    const LibrarySortMode mode = static_cast<LibrarySortMode>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        QVector<LibraryAlbum> albums = library;
+        albums.detach();
+        state.ResumeTiming();
+
+        sortLibraryAlbums(albums, mode);
+        benchmark::DoNotOptimize(albums.constData());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+} // namespace
+
+BENCHMARK(BM_SortLibrary)
+    ->ArgNames({"mode", "albums"})
+    ->ArgsProduct({{SortByArtist, SortByAlbumName, SortByReleaseDate, SortByRating},
+                   {1000, 10000, 100000}})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include <QTemporaryDir>
+#include "LibraryStore.h"
+#include "SyntheticLibrary.h"
+#include "bench_common.h"
+
+namespace {
+
+// Covers are stored as 60x60 PNGs, as addToLibrary does with the thumbnail.
+// One shared blob keeps 100k-album libraries affordable in memory while
+// still writing and reading the full byte volume.
+QVector<LibraryAlbum> makeLibrary(int count)
+{
+    const QByteArray cover = encodeImage(makeCoverImage(60, 1), "PNG");
+    SyntheticLibrary::Options options;
+    options.albumCount = count;
+    return SyntheticLibrary::generate(options, [&cover](int) { return cover; });
+}
+
+void BM_SaveLibrary(benchmark::State& state)
+{
+    const QVector<LibraryAlbum> albums = makeLibrary(static_cast<int>(state.range(0)));
+    QTemporaryDir dir;
+    LibraryStore store(dir.filePath("library.dat"));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.save(albums));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LoadLibrary(benchmark::State& state)
+{
+    QTemporaryDir dir;
+    LibraryStore store(dir.filePath("library.dat"));
+    store.save(makeLibrary(static_cast<int>(state.range(0))));
+
+    for (auto _ : state) {
+        QVector<LibraryAlbum> albums;
+        benchmark::DoNotOptimize(store.load(albums));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_SaveLibrary)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadLibrary)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,18 @@
+#include <benchmark/benchmark.h>
+#include <QGuiApplication>
+
+// Image benchmarks need a QGuiApplication (for image format plugins); the
+// offscreen platform keeps the suite runnable on headless CI machines.
+int main(int argc, char** argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+#include "SpotifyClient.h"
+#include "bench_common.h"
+
+namespace {
+
+void BM_ParseSearchResponse(benchmark::State& state)
+{
+    const std::string response = readBenchData("search_albums.json").toStdString();
+    for (auto _ : state) {
+        SpotifyClient::SearchResult result = SpotifyClient::parseSearchResponse(response, 0);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(response.size()));
+}
+
+void BM_ParseSeveralAlbumsResponse(benchmark::State& state)
+{
+    const std::string response = readBenchData("several_albums.json").toStdString();
+    for (auto _ : state) {
+        std::vector<Album> albums = SpotifyClient::parseSeveralAlbumsResponse(response);
+        benchmark::DoNotOptimize(albums);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(response.size()));
+}
+
+} // namespace
+
+BENCHMARK(BM_ParseSearchResponse)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseSeveralAlbumsResponse)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include <QImage>
+#include "bench_common.h"
+
+namespace {
+
+// What refreshLibraryDisplay pays per row: decoding the stored 60x60 PNG
+void BM_DecodeStoredThumbnail(benchmark::State& state)
+{
+    const QByteArray png = encodeImage(makeCoverImage(60, 3), "PNG");
+    for (auto _ : state) {
+        QImage image;
+        image.loadFromData(png);
+        benchmark::DoNotOptimize(image.constBits());
+    }
+}
+
+// What a search result pays: decoding a cover JPEG of the given edge length
+// (Spotify serves 64, 300 and 640)
+void BM_DecodeCoverJpeg(benchmark::State& state)
+{
+    const int size = static_cast<int>(state.range(0));
+    const QByteArray jpeg = encodeImage(makeCoverImage(size, 5), "JPG", 85);
+    for (auto _ : state) {
+        QImage image;
+        image.loadFromData(jpeg);
+        benchmark::DoNotOptimize(image.constBits());
+    }
+    state.SetBytesProcessed(state.iterations() * jpeg.size());
+}
+
+// Decode plus the smooth downscale the list view's 60x60 label implies
+void BM_DecodeAndScaleCover(benchmark::State& state)
+{
+    const QByteArray jpeg = encodeImage(makeCoverImage(640, 7), "JPG", 85);
+    for (auto _ : state) {
+        QImage image;
+        image.loadFromData(jpeg);
+        QImage thumb = image.scaled(60, 60, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        benchmark::DoNotOptimize(thumb.constBits());
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_DecodeStoredThumbnail)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeCoverJpeg)->Arg(64)->Arg(300)->Arg(640)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeAndScaleCover)->Unit(benchmark::kMicrosecond);
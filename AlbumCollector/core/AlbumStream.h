@@ -0,0 +1,74 @@
+#ifndef ALBUMSTREAM_H
+#define ALBUMSTREAM_H
+
+#include <QDataStream>
+#include <QString>
+#include <QStringList>
+#include "SpotifyClient.h"
+
+// Conversions between the std types used by the Spotify client and the Qt
+// types used for persistence and display
+
+inline QStringList toQStringList(const std::vector<std::string>& values)
+{
+    QStringList list;
+    list.reserve(static_cast<int>(values.size()));
+    for (const auto& value : values) list << QString::fromStdString(value);
+    return list;
+}
+
+inline std::vector<std::string> toStdVector(const QStringList& list)
+{
+    std::vector<std::string> values;
+    values.reserve(list.size());
+    for (const QString& value : list) values.push_back(value.toStdString());
+    return values;
+}
+
+inline QDataStream& operator<<(QDataStream& out, const AlbumDetails& details)
+{
+    out << details.enriched
+        << qint32(details.total_tracks)
+        << toQStringList(details.artists)
+        << QString::fromStdString(details.label)
+        << toQStringList(details.genres);
+    return out;
+}
+
+inline QDataStream& operator>>(QDataStream& in, AlbumDetails& details)
+{
+    qint32 totalTracks = 0;
+    QStringList artists, genres;
+    QString label;
+    in >> details.enriched >> totalTracks >> artists >> label >> genres;
+    details.total_tracks = totalTracks;
+    details.artists = toStdVector(artists);
+    details.label = label.toStdString();
+    details.genres = toStdVector(genres);
+    return in;
+}
+
+inline QDataStream& operator<<(QDataStream& out, const std::vector<ImageRendition>& images)
+{
+    out << quint32(images.size());
+    for (const auto& image : images) {
+        out << QString::fromStdString(image.url) << qint32(image.width) << qint32(image.height);
+    }
+    return out;
+}
+
+inline QDataStream& operator>>(QDataStream& in, std::vector<ImageRendition>& images)
+{
+    quint32 count = 0;
+    in >> count;
+    images.clear();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString url;
+        qint32 width = 0, height = 0;
+        in >> url >> width >> height;
+        images.push_back({url.toStdString(), width, height});
+    }
+    return in;
+}
+
+#endif // ALBUMSTREAM_H
@@ -0,0 +1,178 @@
+#include "ColorSignature.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Dominant colours sit at least this many of the 16 levels per channel
+// apart; anything nearer one counts towards it
+const int Separation = 4;
+
+struct Lab {
+    double l, a, b;
+};
+
+double linear(uint32_t channel)
+{
+    const double c = channel / 255.0;
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+double labCurve(double t)
+{
+    return t > 0.008856 ? std::cbrt(t) : 7.787 * t + 16.0 / 116.0;
+}
+
+// sRGB to CIELAB under D65, where straight-line distance roughly tracks
+// how different two colours look
+Lab toLab(uint32_t rgb)
+{
+    const double r = linear((rgb >> 16) & 0xFF);
+    const double g = linear((rgb >> 8) & 0xFF);
+    const double b = linear(rgb & 0xFF);
+    const double x = labCurve((0.4124 * r + 0.3576 * g + 0.1805 * b) / 0.95047);
+    const double y = labCurve(0.2126 * r + 0.7152 * g + 0.0722 * b);
+    const double z = labCurve((0.0193 * r + 0.1192 * g + 0.9505 * b) / 1.08883);
+    return {116.0 * y - 16.0, 500.0 * (x - y), 200.0 * (y - z)};
+}
+
+int levelDistance2(int binA, int binB)
+{
+    const int dr = (binA >> 8) - (binB >> 8);
+    const int dg = ((binA >> 4) & 0xF) - ((binB >> 4) & 0xF);
+    const int db = (binA & 0xF) - (binB & 0xF);
+    return dr * dr + dg * dg + db * db;
+}
+
+} // namespace
+
+ColorSignature ColorSignature::fromPixels(const uint32_t* pixels, size_t count)
+{
+    ColorSignature signature;
+    if (count == 0) return signature;
+
+    // Quantise to 4 bits per channel in a straight-line pass the compiler
+    // vectorises; only the tally that follows is a scalar scatter
+    std::vector<uint16_t> bins(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t p = pixels[i];
+        bins[i] = static_cast<uint16_t>(((p >> 12) & 0xF00) | ((p >> 8) & 0x0F0) | ((p >> 4) & 0x00F));
+    }
+    std::vector<uint32_t> fine(4096, 0);
+    for (uint16_t bin : bins) ++fine[bin];
+
+    uint32_t coarse[HistogramBins] = {};
+    std::vector<int> used;
+    for (int bin = 0; bin < 4096; ++bin) {
+        if (!fine[bin]) continue;
+        used.push_back(bin);
+        coarse[((bin >> 10) & 3) << 4 | ((bin >> 6) & 3) << 2 | ((bin >> 2) & 3)] += fine[bin];
+    }
+    for (int i = 0; i < HistogramBins; ++i) {
+        signature.histogram[i] = static_cast<uint8_t>((coarse[i] * 255 + count / 2) / count);
+    }
+
+    // Busiest bins first; each becomes a dominant colour unless it is close
+    // to one already chosen
+    std::sort(used.begin(), used.end(), [&fine](int a, int b) { return fine[a] > fine[b]; });
+    std::vector<int> chosen;
+    for (int bin : used) {
+        bool separate = std::all_of(chosen.begin(), chosen.end(), [bin](int other) {
+            return levelDistance2(bin, other) >= Separation * Separation;
+        });
+        if (separate) chosen.push_back(bin);
+        if (chosen.size() == size_t(DominantCount)) break;
+    }
+
+    // Every bin near a dominant colour adds to its share and its mean
+    struct Cluster {
+        uint64_t pixels = 0;
+        uint64_t r = 0, g = 0, b = 0;
+    };
+    std::vector<Cluster> clusters(chosen.size());
+    for (int bin : used) {
+        int nearest = -1;
+        int nearestDistance = Separation * Separation;
+        for (size_t c = 0; c < chosen.size(); ++c) {
+            const int d = levelDistance2(bin, chosen[c]);
+            if (d < nearestDistance) {
+                nearest = int(c);
+                nearestDistance = d;
+            }
+        }
+        if (nearest < 0) continue;
+        Cluster& cluster = clusters[nearest];
+        cluster.pixels += fine[bin];
+        cluster.r += uint64_t(fine[bin]) * ((bin >> 8) * 17);
+        cluster.g += uint64_t(fine[bin]) * (((bin >> 4) & 0xF) * 17);
+        cluster.b += uint64_t(fine[bin]) * ((bin & 0xF) * 17);
+    }
+    std::sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.pixels > b.pixels;
+    });
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const Cluster& cluster = clusters[c];
+        if (!cluster.pixels) continue;
+        signature.dominant[c] = uint32_t(cluster.r / cluster.pixels) << 16 |
+                                uint32_t(cluster.g / cluster.pixels) << 8 |
+                                uint32_t(cluster.b / cluster.pixels);
+        signature.share[c] = static_cast<uint8_t>((cluster.pixels * 255 + count / 2) / count);
+    }
+
+    signature.valid = true;
+    return signature;
+}
+
+double ColorSignature::distanceTo(uint32_t rgb) const
+{
+    if (!valid) return std::numeric_limits<double>::max();
+
+    const Lab target = toLab(rgb);
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < DominantCount; ++i) {
+        if (!share[i]) continue;
+        const Lab colour = toLab(dominant[i]);
+        const double dl = colour.l - target.l;
+        const double da = colour.a - target.a;
+        const double db = colour.b - target.b;
+        // A sliver of the colour should not outrank most of the cover
+        const double distance = std::sqrt(dl * dl + da * da + db * db) + 25.0 * (1.0 - share[i] / 255.0);
+        best = std::min(best, distance);
+    }
+    return best;
+}
+
+int ColorSignature::distance(const ColorSignature& other) const
+{
+    int total = 0;
+    for (int i = 0; i < HistogramBins; ++i) {
+        total += std::abs(int(histogram[i]) - int(other.histogram[i]));
+    }
+    return total;
+}
+
+QDataStream& operator<<(QDataStream& out, const ColorSignature& signature)
+{
+    out << signature.valid;
+    for (int i = 0; i < ColorSignature::DominantCount; ++i) {
+        out << quint32(signature.dominant[i]) << quint8(signature.share[i]);
+    }
+    out.writeRawData(reinterpret_cast<const char*>(signature.histogram), ColorSignature::HistogramBins);
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, ColorSignature& signature)
+{
+    in >> signature.valid;
+    for (int i = 0; i < ColorSignature::DominantCount; ++i) {
+        quint32 dominant = 0;
+        quint8 share = 0;
+        in >> dominant >> share;
+        signature.dominant[i] = dominant;
+        signature.share[i] = share;
+    }
+    in.readRawData(reinterpret_cast<char*>(signature.histogram), ColorSignature::HistogramBins);
+    return in;
+}
@@ -0,0 +1,36 @@
+#ifndef COLORSIGNATURE_H
+#define COLORSIGNATURE_H
+
+#include <QDataStream>
+#include <cstddef>
+#include <cstdint>
+
+// Compact description of a cover's colours: its few dominant colours with
+// how much of the cover each takes up, plus a coarse RGB histogram. Small
+// enough to keep for every library album, so "covers near this colour" and
+// "covers like this one" are arithmetic over memory, not image work.
+struct ColorSignature {
+    static constexpr int DominantCount = 3;
+    static constexpr int HistogramBins = 64;  // 4 levels per channel
+
+    bool valid = false;
+    uint32_t dominant[DominantCount] = {};   // 0xRRGGBB, largest first
+    uint8_t share[DominantCount] = {};       // Fraction of the cover, out of 255
+    uint8_t histogram[HistogramBins] = {};   // Bins sum to about 255
+
+    // From opaque 0xAARRGGBB pixels (QImage::Format_RGB32 scanlines).
+    // A thumbnail is plenty; 64x64 takes a few microseconds.
+    static ColorSignature fromPixels(const uint32_t* pixels, size_t count);
+
+    // How far rgb is from this cover, in CIELAB units: the nearest
+    // dominant colour, nudged towards colours that cover more of it
+    double distanceTo(uint32_t rgb) const;
+
+    // L1 distance between the histograms, 0 (same) to 510 (disjoint)
+    int distance(const ColorSignature& other) const;
+};
+
+QDataStream& operator<<(QDataStream& out, const ColorSignature& signature);
+QDataStream& operator>>(QDataStream& in, ColorSignature& signature);
+
+#endif // COLORSIGNATURE_H
@@ -0,0 +1,131 @@
+#include "CoverHash.h"
+#include <algorithm>
+#include <numeric>
+
+uint64_t CoverHash::differenceHash(const uint8_t* gray)
+{
+    uint64_t hash = 0;
+    int bit = 0;
+    for (int y = 0; y < GridHeight; ++y) {
+        const uint8_t* row = gray + y * GridWidth;
+        for (int x = 0; x < GridWidth - 1; ++x, ++bit) {
+            if (row[x] > row[x + 1]) hash |= uint64_t(1) << bit;
+        }
+    }
+    return hash;
+}
+
+namespace {
+
+uint16_t chunkOf(uint64_t hash, int chunk)
+{
+    return static_cast<uint16_t>(hash >> (16 * chunk));
+}
+
+// Union-find with path halving; clusters are its connected components
+int findRoot(std::vector<int>& parent, int entry)
+{
+    while (parent[entry] != entry) {
+        parent[entry] = parent[parent[entry]];
+        entry = parent[entry];
+    }
+    return entry;
+}
+
+} // namespace
+
+void DuplicateIndex::clear()
+{
+    hashes.clear();
+    for (auto& table : tables) {
+        table.entries.clear();
+        table.offsets.clear();
+    }
+    tablesBuilt = false;
+}
+
+int DuplicateIndex::add(uint64_t hash)
+{
+    hashes.push_back(hash);
+    tablesBuilt = false;
+    return static_cast<int>(hashes.size() - 1);
+}
+
+void DuplicateIndex::buildTables() const
+{
+    if (tablesBuilt) return;
+    for (int c = 0; c < Chunks; ++c) {
+        Table& table = tables[c];
+        table.offsets.assign(65536 + 1, 0);
+        for (uint64_t hash : hashes) ++table.offsets[chunkOf(hash, c) + 1];
+        std::partial_sum(table.offsets.begin(), table.offsets.end(), table.offsets.begin());
+
+        std::vector<uint32_t> fill(table.offsets.begin(), table.offsets.end() - 1);
+        table.entries.resize(hashes.size());
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            table.entries[fill[chunkOf(hashes[i], c)]++] = static_cast<int>(i);
+        }
+    }
+    tablesBuilt = true;
+}
+
+// Visits the entries whose chunk is within radius bits of chunk
+template <typename Visit>
+void DuplicateIndex::probe(int table, uint16_t chunk, int radius, Visit&& visit) const
+{
+    const Table& buckets = tables[table];
+    auto visitBucket = [&](uint16_t value) {
+        for (uint32_t i = buckets.offsets[value]; i < buckets.offsets[value + 1]; ++i) {
+            visit(buckets.entries[i]);
+        }
+    };
+
+    visitBucket(chunk);
+    if (radius < 1) return;
+    for (int i = 0; i < 16; ++i) {
+        const uint16_t one = chunk ^ uint16_t(1u << i);
+        visitBucket(one);
+        if (radius < 2) continue;
+        for (int j = i + 1; j < 16; ++j) visitBucket(one ^ uint16_t(1u << j));
+    }
+}
+
+std::vector<std::vector<int>> DuplicateIndex::clusters(int maxDistance) const
+{
+    maxDistance = std::clamp(maxDistance, 0, MaxDistance);
+    buildTables();
+
+    const int count = static_cast<int>(hashes.size());
+    std::vector<int> parent(count);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    const int radius = maxDistance / Chunks;
+    for (int entry = 0; entry < count; ++entry) {
+        const uint64_t hash = hashes[entry];
+        for (int c = 0; c < Chunks; ++c) {
+            probe(c, chunkOf(hash, c), radius, [&](int other) {
+                // Each pair is found from both ends; handle it once
+                if (other <= entry) return;
+                if (CoverHash::distance(hash, hashes[other]) > maxDistance) return;
+                const int a = findRoot(parent, entry);
+                const int b = findRoot(parent, other);
+                if (a != b) parent[std::max(a, b)] = std::min(a, b);
+            });
+        }
+    }
+
+    std::vector<std::vector<int>> groups(count);
+    for (int entry = 0; entry < count; ++entry) {
+        groups[findRoot(parent, entry)].push_back(entry);
+    }
+
+    std::vector<std::vector<int>> result;
+    for (auto& group : groups) {
+        if (group.size() > 1) result.push_back(std::move(group));
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const std::vector<int>& a, const std::vector<int>& b) {
+                         return a.size() > b.size();
+                     });
+    return result;
+}
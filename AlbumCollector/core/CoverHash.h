@@ -0,0 +1,68 @@
+#ifndef COVERHASH_H
+#define COVERHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Perceptual hashes of cover art and a search structure for finding
+// near-identical ones. Decoding and scaling covers needs QtGui, so callers
+// hand in the small grayscale grid; everything here is plain arithmetic.
+namespace CoverHash {
+
+constexpr int GridWidth = 9;
+constexpr int GridHeight = 8;
+
+// dHash: one bit per horizontally adjacent pair of the 9x8 luminance grid
+// (row-major), set when the left pixel is brighter. Survives rescaling,
+// recompression and small colour shifts; flat images hash to 0.
+uint64_t differenceHash(const uint8_t* gray);
+
+inline int distance(uint64_t a, uint64_t b)
+{
+    return __builtin_popcountll(a ^ b);
+}
+
+} // namespace CoverHash
+
+// Multi-index hash over 64-bit hashes. Each hash is split into four 16-bit
+// chunks with one sorted table per chunk; two hashes within distance d
+// agree to within d/4 bits in at least one chunk, so a query only probes
+// the few buckets around its own chunks instead of every entry. Random
+// hashes leave about one entry per bucket even at 100k covers.
+class DuplicateIndex {
+public:
+    // Largest distance the chunk probing supports (two bits per chunk)
+    static constexpr int MaxDistance = 11;
+
+    void clear();
+    void reserve(size_t count) { hashes.reserve(count); }
+
+    // Entries are numbered in insertion order
+    int add(uint64_t hash);
+    size_t size() const { return hashes.size(); }
+
+    // Groups of at least two entries linked by distance <= maxDistance
+    // (single linkage), each sorted, largest group first
+    std::vector<std::vector<int>> clusters(int maxDistance) const;
+
+private:
+    static constexpr int Chunks = 4;
+
+    // Entries grouped by chunk value (a counting sort), with bucket v
+    // spanning entries[offsets[v]] .. entries[offsets[v + 1]]
+    struct Table {
+        std::vector<int> entries;
+        std::vector<uint32_t> offsets;
+    };
+
+    std::vector<uint64_t> hashes;
+    mutable Table tables[Chunks];
+    mutable bool tablesBuilt = false;
+
+    void buildTables() const;
+    template <typename Visit>
+    void probe(int table, uint16_t chunk, int radius, Visit&& visit) const;
+};
+
+#endif // COVERHASH_H
@@ -0,0 +1,100 @@
+#include "LibraryExport.h"
+#include <cstdio>
+
+namespace {
+
+std::string hexColor(uint32_t rgb)
+{
+    char text[8];
+    std::snprintf(text, sizeof(text), "#%06X", unsigned(rgb & 0xFFFFFF));
+    return text;
+}
+
+std::string joined(const std::vector<std::string>& values)
+{
+    std::string result;
+    for (const auto& value : values) {
+        if (!result.empty()) result += "; ";
+        result += value;
+    }
+    return result;
+}
+
+std::vector<std::string> dominantColors(const ColorSignature& colors)
+{
+    std::vector<std::string> result;
+    if (!colors.valid) return result;
+    for (int i = 0; i < ColorSignature::DominantCount; ++i) {
+        if (colors.share[i]) result.push_back(hexColor(colors.dominant[i]));
+    }
+    return result;
+}
+
+// Every field goes in after a comma; csvRow drops the first one
+void appendCsvField(QByteArray& row, const std::string& value)
+{
+    row += ',';
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        row += QByteArray::fromStdString(value);
+        return;
+    }
+    row += '"';
+    for (char c : value) {
+        if (c == '"') row += '"';
+        row += c;
+    }
+    row += '"';
+}
+
+} // namespace
+
+QByteArray LibraryExport::jsonLine(const LibraryAlbum& libAlbum)
+{
+    const Album& album = libAlbum.album;
+    json object = {
+        {"id", album.id},
+        {"name", album.name},
+        {"artist", album.artist},
+        {"release_date", album.release_date},
+        {"rating", album.rating},
+        {"image_url", album.image_url},
+    };
+    if (album.details.enriched || !album.details.artists.empty()) {
+        object["artists"] = album.details.artists;
+        object["total_tracks"] = album.details.total_tracks;
+    }
+    if (album.details.enriched) {
+        object["label"] = album.details.label;
+        object["genres"] = album.details.genres;
+    }
+    if (libAlbum.colors.valid) object["colors"] = dominantColors(libAlbum.colors);
+
+    // Replace rather than throw on the odd invalid UTF-8 byte from old data
+    std::string line = object.dump(-1, ' ', false, json::error_handler_t::replace);
+    line += '\n';
+    return QByteArray::fromStdString(line);
+}
+
+QByteArray LibraryExport::csvHeader()
+{
+    return "id,name,artist,release_date,rating,artists,total_tracks,label,genres,image_url,colors\r\n";
+}
+
+QByteArray LibraryExport::csvRow(const LibraryAlbum& libAlbum)
+{
+    const Album& album = libAlbum.album;
+    QByteArray row;
+    appendCsvField(row, album.id);
+    appendCsvField(row, album.name);
+    appendCsvField(row, album.artist);
+    appendCsvField(row, album.release_date);
+    appendCsvField(row, album.rating > 0 ? std::to_string(album.rating) : std::string());
+    appendCsvField(row, joined(album.details.artists));
+    appendCsvField(row, album.details.total_tracks > 0 ? std::to_string(album.details.total_tracks) : std::string());
+    appendCsvField(row, album.details.label);
+    appendCsvField(row, joined(album.details.genres));
+    appendCsvField(row, album.image_url);
+    appendCsvField(row, joined(dominantColors(libAlbum.colors)));
+    row += "\r\n";
+    return row.mid(1);
+}
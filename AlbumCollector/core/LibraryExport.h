@@ -0,0 +1,22 @@
+#ifndef LIBRARYEXPORT_H
+#define LIBRARYEXPORT_H
+
+#include <QByteArray>
+#include "LibraryStore.h"
+
+// Plain-text forms of a library record for getting data out of library.dat.
+// Each call formats one album, so exporters can stream records straight
+// from LibraryStore::Reader. Covers are left out; they are binary and
+// belong in files of their own.
+namespace LibraryExport {
+
+// One JSON object and a trailing newline (JSON Lines)
+QByteArray jsonLine(const LibraryAlbum& libAlbum);
+
+// RFC 4180 CSV, UTF-8; list fields are joined with "; "
+QByteArray csvHeader();
+QByteArray csvRow(const LibraryAlbum& libAlbum);
+
+} // namespace LibraryExport
+
+#endif // LIBRARYEXPORT_H
@@ -0,0 +1,59 @@
+#include "LibraryFacets.h"
+
+namespace {
+
+template <typename Key, typename DocSet>
+void applySelection(DocBitmap& result, const Facet<Key, DocSet>& facet, const std::optional<Key>& value)
+{
+    if (value) facet.intersect(result, *value);
+}
+
+} // namespace
+
+int LibraryFacets::decadeOf(const std::string& releaseDate)
+{
+    if (releaseDate.size() < 4) return -1;
+
+    int year = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = releaseDate[i];
+        if (c < '0' || c > '9') return -1;
+        year = year * 10 + (c - '0');
+    }
+    return year > 0 ? year / 10 * 10 : -1;
+}
+
+void LibraryFacets::add(DocId doc, const Album& album)
+{
+    ratingFacet.assign(doc, album.rating);
+    decadeFacet.assign(doc, decadeOf(album.release_date));
+    artistFacet.assign(doc, QString::fromStdString(album.artist));
+}
+
+void LibraryFacets::remove(DocId doc)
+{
+    ratingFacet.remove(doc);
+    decadeFacet.remove(doc);
+    artistFacet.remove(doc);
+}
+
+void LibraryFacets::setRating(DocId doc, int rating)
+{
+    ratingFacet.assign(doc, rating);
+}
+
+void LibraryFacets::clear()
+{
+    ratingFacet.clear();
+    decadeFacet.clear();
+    artistFacet.clear();
+}
+
+DocBitmap LibraryFacets::filter(const DocBitmap& base, const Selection& selection, Field skip) const
+{
+    DocBitmap result = base;
+    if (skip != RatingField) applySelection(result, ratingFacet, selection.rating);
+    if (skip != DecadeField) applySelection(result, decadeFacet, selection.decade);
+    if (skip != ArtistField) applySelection(result, artistFacet, selection.artist);
+    return result;
+}
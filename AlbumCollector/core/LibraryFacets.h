@@ -0,0 +1,159 @@
+#ifndef LIBRARYFACETS_H
+#define LIBRARYFACETS_H
+
+#include <QString>
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "DocBitmap.h"
+#include "LibraryIndex.h"
+
+// Sorted document ids: the sparse counterpart of DocBitmap for values only
+// a few documents carry. Memory follows the number of documents rather than
+// the highest document id, which matters with one set per artist.
+class DocList {
+public:
+    void set(uint32_t doc) {
+        auto it = std::lower_bound(docs.begin(), docs.end(), doc);
+        if (it == docs.end() || *it != doc) docs.insert(it, doc);
+    }
+
+    void reset(uint32_t doc) {
+        auto it = std::lower_bound(docs.begin(), docs.end(), doc);
+        if (it != docs.end() && *it == doc) docs.erase(it);
+    }
+
+    bool any() const { return !docs.empty(); }
+
+    uint32_t countAnd(const DocBitmap& mask) const {
+        uint32_t total = 0;
+        for (uint32_t doc : docs) total += mask.test(doc) ? 1 : 0;
+        return total;
+    }
+
+    // Clears every document in result that is not in the list
+    void intersectInto(DocBitmap& result) const {
+        DocBitmap kept(result.size());
+        for (uint32_t doc : docs) {
+            if (result.test(doc)) kept.set(doc);
+        }
+        result = std::move(kept);
+    }
+
+private:
+    std::vector<uint32_t> docs;
+};
+
+// One facet: the documents per value, plus each document's current value
+// so it can be moved or removed without scanning every set. Few-valued
+// facets keep dense DocBitmaps; high-cardinality ones use DocList.
+template <typename Key, typename DocSet = DocBitmap>
+class Facet {
+public:
+    using DocId = LibraryIndex::DocId;
+
+    void assign(DocId doc, const Key& key) {
+        remove(doc);
+        if (doc >= docKeys.size()) {
+            docKeys.resize(doc + 1);
+            hasKey.resize(doc + 1, false);
+        }
+        sets[key].set(doc);
+        docKeys[doc] = key;
+        hasKey[doc] = true;
+    }
+
+    void remove(DocId doc) {
+        if (doc >= docKeys.size() || !hasKey[doc]) return;
+        auto it = sets.find(docKeys[doc]);
+        if (it != sets.end()) {
+            it->second.reset(doc);
+            if (!it->second.any()) sets.erase(it);
+        }
+        hasKey[doc] = false;
+    }
+
+    void clear() {
+        sets.clear();
+        docKeys.clear();
+        hasKey.clear();
+    }
+
+    // Keeps only the documents in result that have key
+    void intersect(DocBitmap& result, const Key& key) const {
+        auto it = sets.find(key);
+        if (it == sets.end()) {
+            result = DocBitmap(result.size());
+        } else {
+            intersectWith(result, it->second);
+        }
+    }
+
+    // Number of documents in the mask for every value, in key order. Few
+    // values: AND-count each set; many values (artists): tally the mask's
+    // documents instead, which does not grow with the value count.
+    std::vector<std::pair<Key, uint32_t>> counts(const DocBitmap& mask) const {
+        std::vector<std::pair<Key, uint32_t>> result;
+        if (sets.size() <= 64) {
+            for (const auto& entry : sets) {
+                result.emplace_back(entry.first, entry.second.countAnd(mask));
+            }
+            return result;
+        }
+
+        std::map<Key, uint32_t> tally;
+        mask.forEach([&](uint32_t doc) {
+            if (doc < docKeys.size() && hasKey[doc]) ++tally[docKeys[doc]];
+        });
+        result.assign(tally.begin(), tally.end());
+        return result;
+    }
+
+private:
+    static void intersectWith(DocBitmap& result, const DocBitmap& set) { result &= set; }
+    static void intersectWith(DocBitmap& result, const DocList& set) { set.intersectInto(result); }
+
+    std::map<Key, DocSet> sets;
+    std::vector<Key> docKeys;
+    std::vector<bool> hasKey;
+};
+
+// Rating, release decade and artist facets for the library filter panel.
+// Kept in step with LibraryIndex document ids and updated incrementally.
+class LibraryFacets {
+public:
+    using DocId = LibraryIndex::DocId;
+
+    enum Field { None, RatingField, DecadeField, ArtistField };
+
+    struct Selection {
+        std::optional<int> rating;   // 0 = unrated, as in RatingWidget
+        std::optional<int> decade;   // e.g. 1990; -1 = unknown date
+        std::optional<QString> artist;
+    };
+
+    void add(DocId doc, const Album& album);
+    void remove(DocId doc);
+    void setRating(DocId doc, int rating);
+    void clear();
+
+    // Documents in base that satisfy the selection, ignoring the selection
+    // on `skip` (used to count the alternatives within that facet)
+    DocBitmap filter(const DocBitmap& base, const Selection& selection, Field skip = None) const;
+
+    const Facet<int>& ratings() const { return ratingFacet; }
+    const Facet<int>& decades() const { return decadeFacet; }
+    const Facet<QString, DocList>& artists() const { return artistFacet; }
+
+    // Decade of a Spotify release_date ("1997-05-21", "1997-05" or "1997")
+    static int decadeOf(const std::string& releaseDate);
+
+private:
+    Facet<int> ratingFacet;
+    Facet<int> decadeFacet;
+    Facet<QString, DocList> artistFacet;  // Thousands of values
+};
+
+#endif // LIBRARYFACETS_H
@@ -0,0 +1,289 @@
+#include "LibraryImport.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+bool isBase62(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+std::string trimmed(const std::string& text)
+{
+    return QString::fromStdString(text).trimmed().toStdString();
+}
+
+QString folded(const std::string& text)
+{
+    return QString::fromStdString(text).simplified().toCaseFolded();
+}
+
+// RFC 4180 fields: quoted fields may hold commas, newlines and "" escapes
+std::vector<std::vector<std::string>> parseCsv(const QByteArray& data)
+{
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::string> row;
+    std::string field;
+    bool quoted = false;
+    bool fieldStarted = false;
+
+    auto endField = [&]() {
+        row.push_back(trimmed(field));
+        field.clear();
+        fieldStarted = false;
+    };
+    auto endRow = [&]() {
+        if (fieldStarted || !field.empty() || !row.empty()) endField();
+        bool blank = std::all_of(row.begin(), row.end(), [](const std::string& f) { return f.empty(); });
+        if (!blank) rows.push_back(row);
+        row.clear();
+    };
+
+    for (int i = 0; i < data.size(); ++i) {
+        const char c = data[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < data.size() && data[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+            fieldStarted = true;
+        } else if (c == ',') {
+            endField();
+            fieldStarted = true;
+        } else if (c == '\n') {
+            endRow();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    endRow();
+    return rows;
+}
+
+std::vector<ImportEntry> parseCsvEntries(const QByteArray& data)
+{
+    std::vector<std::vector<std::string>> rows = parseCsv(data);
+    if (rows.empty()) return {};
+
+    int idColumn = -1, artistColumn = -1, albumColumn = -1;
+    size_t first = 0;
+    const auto& header = rows.front();
+    for (size_t c = 0; c < header.size(); ++c) {
+        const QString name = folded(header[c]);
+        if (name == "id" || name == "spotify_id" || name == "uri" || name == "url") idColumn = int(c);
+        else if (name == "artist") artistColumn = int(c);
+        else if (name == "album" || name == "name" || name == "title") albumColumn = int(c);
+    }
+    if (idColumn >= 0 || artistColumn >= 0 || albumColumn >= 0) {
+        first = 1;
+    } else if (header.size() == 1) {
+        idColumn = 0;
+    } else {
+        artistColumn = 0;
+        albumColumn = 1;
+    }
+
+    std::vector<ImportEntry> entries;
+    for (size_t r = first; r < rows.size(); ++r) {
+        const auto& row = rows[r];
+        auto column = [&row](int c) { return c >= 0 && size_t(c) < row.size() ? row[c] : std::string(); };
+        ImportEntry entry;
+        entry.id = LibraryImport::albumId(column(idColumn));
+        entry.artist = column(artistColumn);
+        entry.album = column(albumColumn);
+        if (!entry.id.empty() || (!entry.artist.empty() && !entry.album.empty())) {
+            entries.push_back(std::move(entry));
+        }
+    }
+    return entries;
+}
+
+std::vector<ImportEntry> parseJsonEntries(const QByteArray& data)
+{
+    std::vector<ImportEntry> entries;
+    try {
+        json parsed = json::parse(data.constData(), data.constData() + data.size());
+        if (!parsed.is_array()) return entries;
+        for (const auto& item : parsed) {
+            ImportEntry entry;
+            if (item.is_string()) {
+                entry.id = LibraryImport::albumId(item.get<std::string>());
+            } else if (item.is_object()) {
+                for (const char* key : {"id", "spotify_id", "uri", "url"}) {
+                    if (entry.id.empty() && item.contains(key) && item[key].is_string()) {
+                        entry.id = LibraryImport::albumId(item[key].get<std::string>());
+                    }
+                }
+                entry.artist = trimmed(item.value("artist", std::string()));
+                entry.album = trimmed(item.value("album", item.value("name", std::string())));
+            }
+            if (!entry.id.empty() || (!entry.artist.empty() && !entry.album.empty())) {
+                entries.push_back(std::move(entry));
+            }
+        }
+    } catch (...) {
+        // Not JSON after all; nothing to import
+    }
+    return entries;
+}
+
+} // namespace
+
+std::vector<ImportEntry> LibraryImport::parse(const QByteArray& data)
+{
+    const QByteArray start = data.trimmed().left(1);
+    if (start == "[" || start == "{") return parseJsonEntries(data);
+    return parseCsvEntries(data);
+}
+
+std::string LibraryImport::albumId(const std::string& text)
+{
+    std::string value = trimmed(text);
+    for (const std::string prefix : {"spotify:album:", "/album/"}) {
+        size_t at = value.find(prefix);
+        if (at != std::string::npos) {
+            value = value.substr(at + prefix.size());
+            break;
+        }
+    }
+    size_t length = 0;
+    while (length < value.size() && isBase62(value[length])) ++length;
+    return length == 22 ? value.substr(0, length) : std::string();
+}
+
+std::string LibraryImport::searchQuery(const ImportEntry& entry)
+{
+    return "album:\"" + entry.album + "\" artist:\"" + entry.artist + "\"";
+}
+
+const Album* LibraryImport::bestMatch(const std::vector<Album>& results, const ImportEntry& entry)
+{
+    const QString album = folded(entry.album);
+    const QString artist = folded(entry.artist);
+    const Album* best = nullptr;
+    int bestScore = 0;
+    for (const Album& result : results) {
+        const QString name = folded(result.name);
+        const QString resultArtist = folded(result.artist);
+        // Deluxe and remastered editions add a suffix to the same title
+        int score = name == album ? 3 : name.startsWith(album) ? 1 : 0;
+        if (score == 0) continue;
+        score += resultArtist == artist ? 2 : resultArtist.contains(artist) ? 1 : -10;
+        if (score > bestScore) {
+            best = &result;
+            bestScore = score;
+        }
+    }
+    return bestScore >= 2 ? best : nullptr;
+}
+
+ImportJournal::ImportJournal(const QString& filePath)
+    : filePath(filePath)
+{
+}
+
+QString ImportJournal::pathFor(const QByteArray& importData)
+{
+    const QByteArray digest = QCryptographicHash::hash(importData, QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        + "/imports/" + QString::fromLatin1(digest.left(16)) + ".journal";
+}
+
+QHash<int, std::string> ImportJournal::load() const
+{
+    QHash<int, std::string> resolved;
+    QFile in(filePath);
+    if (!in.open(QIODevice::ReadOnly | QIODevice::Text)) return resolved;
+
+    // A torn last line from a crash fails to parse and is simply redone
+    while (!in.atEnd()) {
+        const QList<QByteArray> fields = in.readLine().trimmed().split('\t');
+        bool ok = false;
+        const int index = fields.value(0).toInt(&ok);
+        if (!ok || fields.size() != 2) continue;
+        const QByteArray id = fields[1] == "-" ? QByteArray() : fields[1];
+        resolved.insert(index, id.toStdString());
+    }
+    return resolved;
+}
+
+bool ImportJournal::record(int index, const std::string& id)
+{
+    if (!file.isOpen()) {
+        QDir().mkpath(QFileInfo(filePath).absolutePath());
+        file.setFileName(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return false;
+    }
+    const QByteArray line = QByteArray::number(index) + '\t'
+        + (id.empty() ? QByteArray("-") : QByteArray::fromStdString(id)) + '\n';
+    return file.write(line) == line.size() && file.flush();
+}
+
+QString ImportJournal::albumPath() const
+{
+    QString path = filePath;
+    path.chop(QFileInfo(filePath).suffix().size());
+    return path + "albums";
+}
+
+std::unordered_map<std::string, ImportJournal::FetchedAlbum> ImportJournal::loadAlbums() const
+{
+    std::unordered_map<std::string, FetchedAlbum> fetched;
+    QFile in(albumPath());
+    if (!in.open(QIODevice::ReadOnly)) return fetched;
+
+    QDataStream stream(&in);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 version = 0;
+    stream >> version;
+    if (version == 0 || version > LibraryStore::Version) return fetched;
+
+    // As with the id journal, a torn last record is simply redone
+    while (!stream.atEnd()) {
+        bool coverDone = false;
+        stream >> coverDone;
+        LibraryAlbum libAlbum = LibraryStore::readRecord(stream, version);
+        if (stream.status() != QDataStream::Ok) break;
+        const std::string id = libAlbum.album.id;
+        fetched.insert_or_assign(id, FetchedAlbum{std::move(libAlbum), coverDone});
+    }
+    return fetched;
+}
+
+bool ImportJournal::recordAlbum(const LibraryAlbum& libAlbum, bool coverDone)
+{
+    if (!albumFile.isOpen()) {
+        QDir().mkpath(QFileInfo(filePath).absolutePath());
+        albumFile.setFileName(albumPath());
+        if (!albumFile.open(QIODevice::WriteOnly | QIODevice::Append)) return false;
+    }
+
+    QDataStream out(&albumFile);
+    out.setVersion(QDataStream::Qt_6_0);
+    if (albumFile.size() == 0) out << LibraryStore::Version;
+    out << coverDone;
+    LibraryStore::writeRecord(out, libAlbum);
+    return out.status() == QDataStream::Ok && albumFile.flush();
+}
+
+void ImportJournal::remove()
+{
+    file.close();
+    albumFile.close();
+    QFile::remove(filePath);
+    QFile::remove(albumPath());
+}
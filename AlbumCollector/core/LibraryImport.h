@@ -0,0 +1,85 @@
+#ifndef LIBRARYIMPORT_H
+#define LIBRARYIMPORT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LibraryStore.h"
+#include "SpotifyClient.h"
+
+// One line of an import file: a Spotify album id, or an artist and album
+// name to look up
+struct ImportEntry {
+    std::string id;
+    std::string artist;
+    std::string album;
+};
+
+namespace LibraryImport {
+
+// Reads CSV or JSON, told apart by the first non-blank character.
+//  CSV:  an optional header naming artist, album and id columns; without
+//        one, a single column is ids and two or more are artist, album.
+//  JSON: an array of id strings or of {"artist", "album", "id"} objects.
+// Ids may be bare, spotify:album: URIs or open.spotify.com links. Lines
+// that are neither an id nor a complete pair are skipped.
+std::vector<ImportEntry> parse(const QByteArray& data);
+
+// The 22-character album id inside an id, URI or link; empty if none
+std::string albumId(const std::string& text);
+
+// Field-filtered search query for a name pair
+std::string searchQuery(const ImportEntry& entry);
+
+// The search result that is the entry's album, or nullptr when none is a
+// convincing match (same title, and the artist at least contained)
+const Album* bestMatch(const std::vector<Album>& results, const ImportEntry& entry);
+
+} // namespace LibraryImport
+
+// Append-only record of resolved entries, so an interrupted import picks up
+// where it stopped instead of searching again. Keyed by the import file's
+// contents: the same file resumes, an edited one starts over. Fetched
+// albums go to a companion .albums file of library records, so a resume
+// does not fetch them again or, once their cover is in, download it again.
+class ImportJournal {
+public:
+    // A fetched album; coverDone once its cover download has been tried
+    struct FetchedAlbum {
+        LibraryAlbum libAlbum;
+        bool coverDone = false;
+    };
+
+    explicit ImportJournal(const QString& filePath);
+
+    // imports/<hash>.journal in the application data directory
+    static QString pathFor(const QByteArray& importData);
+
+    // Entry index to album id; an empty id means the lookup found nothing
+    QHash<int, std::string> load() const;
+
+    // Written through immediately; safe from one thread at a time
+    bool record(int index, const std::string& id);
+
+    // Fetched albums by id, the latest record for each
+    std::unordered_map<std::string, FetchedAlbum> loadAlbums() const;
+
+    // Same threading rules as record()
+    bool recordAlbum(const LibraryAlbum& libAlbum, bool coverDone);
+
+    // Once the import is committed to the library
+    void remove();
+
+private:
+    QString filePath;
+    QFile file;
+    QFile albumFile;
+
+    QString albumPath() const;
+};
+
+#endif // LIBRARYIMPORT_H
@@ -0,0 +1,288 @@
+#include "LibraryIndex.h"
+#include <algorithm>
+
+namespace {
+
+// Smallest edit distance between the query and any prefix of the token, or
+// maxDist + 1 once it is certain to exceed maxDist
+int boundedPrefixDistance(const QString& query, const QString& token, int maxDist)
+{
+    const int n = query.size();
+    const int m = token.size();
+    if (n - maxDist > m) return maxDist + 1;
+
+    // prev[j] = distance between query[0..i) and token[0..j)
+    std::vector<int> prev(m + 1), row(m + 1);
+    for (int j = 0; j <= m; ++j) prev[j] = j;
+
+    for (int i = 1; i <= n; ++i) {
+        row[0] = i;
+        int rowMin = row[0];
+        for (int j = 1; j <= m; ++j) {
+            int cost = query[i - 1] == token[j - 1] ? 0 : 1;
+            row[j] = std::min({prev[j] + 1, row[j - 1] + 1, prev[j - 1] + cost});
+            rowMin = std::min(rowMin, row[j]);
+        }
+        if (rowMin > maxDist) return maxDist + 1;
+        std::swap(prev, row);
+    }
+
+    // Any prefix of the token may match, so take the best column
+    return std::min(maxDist + 1, *std::min_element(prev.begin(), prev.end()));
+}
+
+} // namespace
+
+QStringList LibraryIndex::tokenize(const QString& text)
+{
+    // Compatibility decomposition splits accented letters into base letter
+    // plus combining mark, and the marks are then dropped
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString cleaned;
+    cleaned.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing) continue;
+        cleaned += c.isLetterOrNumber() ? c : QLatin1Char(' ');
+    }
+    return cleaned.toCaseFolded().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+}
+
+LibraryIndex::DocId LibraryIndex::add(const Album& album)
+{
+    remove(album.id);
+
+    DocId doc;
+    if (!freeDocs.empty()) {
+        doc = freeDocs.back();
+        freeDocs.pop_back();
+    } else {
+        doc = static_cast<DocId>(docAlbumIds.size());
+        docAlbumIds.emplace_back();
+        docTokens.emplace_back();
+    }
+
+    QStringList tokens = tokenize(QString::fromStdString(album.name + " " + album.artist));
+    tokens.removeDuplicates();
+
+    for (const QString& token : tokens) {
+        std::vector<DocId>& list = addToken(token)->second.docs;
+        list.insert(std::lower_bound(list.begin(), list.end(), doc), doc);
+    }
+
+    ids[album.id] = doc;
+    docAlbumIds[doc] = album.id;
+    docTokens[doc] = tokens;
+    return doc;
+}
+
+void LibraryIndex::remove(const std::string& albumId)
+{
+    auto it = ids.find(albumId);
+    if (it == ids.end()) return;
+
+    const DocId doc = it->second;
+    for (const QString& token : docTokens[doc]) {
+        auto posting = postings.find(token);
+        if (posting == postings.end()) continue;
+
+        std::vector<DocId>& list = posting->second.docs;
+        auto pos = std::lower_bound(list.begin(), list.end(), doc);
+        if (pos != list.end() && *pos == doc) list.erase(pos);
+        if (list.empty()) removeToken(posting);
+    }
+
+    docTokens[doc].clear();
+    docAlbumIds[doc].clear();
+    freeDocs.push_back(doc);
+    ids.erase(it);
+}
+
+void LibraryIndex::clear()
+{
+    ids.clear();
+    docAlbumIds.clear();
+    docTokens.clear();
+    freeDocs.clear();
+    postings.clear();
+    vocabulary.clear();
+    freeTokenIds.clear();
+    trigramPostings.clear();
+}
+
+LibraryIndex::DocId LibraryIndex::docId(const std::string& albumId) const
+{
+    auto it = ids.find(albumId);
+    return it == ids.end() ? InvalidDoc : it->second;
+}
+
+DocBitmap LibraryIndex::allDocs() const
+{
+    DocBitmap docs(docCapacity(), true);
+    for (DocId doc : freeDocs) docs.reset(doc);
+    return docs;
+}
+
+DocBitmap LibraryIndex::search(const QString& query) const
+{
+    const QStringList words = tokenize(query);
+    DocBitmap result;
+    bool first = true;
+
+    for (const QString& word : words) {
+        // Union of the postings of every token starting with this word
+        DocBitmap matches(docCapacity());
+        for (auto it = postings.lower_bound(word);
+             it != postings.end() && it->first.startsWith(word); ++it) {
+            for (DocId doc : it->second.docs) matches.set(doc);
+        }
+
+        if (first) {
+            result = std::move(matches);
+            first = false;
+        } else {
+            result &= matches;
+        }
+        if (!result.any()) break;
+    }
+
+    if (first) result.resize(docCapacity());
+    return result;
+}
+
+int LibraryIndex::maxEditsFor(int length)
+{
+    if (length < 4) return 0;
+    return length < 7 ? 1 : 2;
+}
+
+std::vector<uint64_t> LibraryIndex::trigrams(const QString& word)
+{
+    // A leading boundary marker makes the first letters count, but there is
+    // no trailing one: queries are matched against token prefixes
+    const QString padded = QChar(0x01) + word;
+
+    std::vector<uint64_t> result;
+    for (int i = 0; i + 3 <= padded.size(); ++i) {
+        result.push_back(uint64_t(padded[i].unicode()) << 32 |
+                         uint64_t(padded[i + 1].unicode()) << 16 |
+                         uint64_t(padded[i + 2].unicode()));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+LibraryIndex::PostingMap::iterator LibraryIndex::addToken(const QString& token)
+{
+    auto it = postings.find(token);
+    if (it != postings.end()) return it;
+
+    uint32_t tokenId;
+    if (!freeTokenIds.empty()) {
+        tokenId = freeTokenIds.back();
+        freeTokenIds.pop_back();
+    } else {
+        tokenId = static_cast<uint32_t>(vocabulary.size());
+        vocabulary.push_back(postings.end());
+    }
+
+    it = postings.emplace(token, Posting{{}, tokenId}).first;
+    vocabulary[tokenId] = it;
+    for (uint64_t trigram : trigrams(token)) {
+        std::vector<uint32_t>& list = trigramPostings[trigram];
+        list.insert(std::lower_bound(list.begin(), list.end(), tokenId), tokenId);
+    }
+    return it;
+}
+
+void LibraryIndex::removeToken(PostingMap::iterator posting)
+{
+    const uint32_t tokenId = posting->second.tokenId;
+    for (uint64_t trigram : trigrams(posting->first)) {
+        auto it = trigramPostings.find(trigram);
+        if (it == trigramPostings.end()) continue;
+
+        std::vector<uint32_t>& list = it->second;
+        auto pos = std::lower_bound(list.begin(), list.end(), tokenId);
+        if (pos != list.end() && *pos == tokenId) list.erase(pos);
+        if (list.empty()) trigramPostings.erase(it);
+    }
+
+    vocabulary[tokenId] = postings.end();
+    freeTokenIds.push_back(tokenId);
+    postings.erase(posting);
+}
+
+std::vector<LibraryIndex::FuzzyMatch> LibraryIndex::fuzzySearch(const QString& query) const
+{
+    const QStringList words = tokenize(query);
+    std::vector<FuzzyMatch> results;
+    if (words.isEmpty()) return results;
+
+    const uint8_t NoMatch = UINT8_MAX;
+    std::vector<int> totalDistance(docCapacity(), 0);
+    DocBitmap alive = allDocs();
+
+    std::vector<uint16_t> shared(vocabulary.size(), 0);
+    std::vector<uint8_t> best(docCapacity(), NoMatch);
+
+    for (const QString& word : words) {
+        const int maxEdits = maxEditsFor(word.size());
+        std::vector<std::pair<uint32_t, int>> tokens;  // token id, distance
+
+        // Exact prefix matches are distance 0 and need no verification
+        for (auto it = postings.lower_bound(word);
+             it != postings.end() && it->first.startsWith(word); ++it) {
+            tokens.emplace_back(it->second.tokenId, 0);
+        }
+
+        if (maxEdits > 0) {
+            // Each edit destroys at most three trigrams, so a candidate must
+            // share at least this many with the query
+            const std::vector<uint64_t> grams = trigrams(word);
+            const int threshold = std::max(1, static_cast<int>(grams.size()) - 3 * maxEdits);
+
+            std::vector<uint32_t> touched;
+            for (uint64_t gram : grams) {
+                auto it = trigramPostings.find(gram);
+                if (it == trigramPostings.end()) continue;
+                for (uint32_t tokenId : it->second) {
+                    if (shared[tokenId]++ == 0) touched.push_back(tokenId);
+                }
+            }
+
+            for (uint32_t tokenId : touched) {
+                if (shared[tokenId] >= threshold) {
+                    const QString& token = vocabulary[tokenId]->first;
+                    if (!token.startsWith(word)) {
+                        int distance = boundedPrefixDistance(word, token, maxEdits);
+                        if (distance <= maxEdits) tokens.emplace_back(tokenId, distance);
+                    }
+                }
+                shared[tokenId] = 0;
+            }
+        }
+
+        // Re-rank: a document scores the closest of its words to this query word
+        std::fill(best.begin(), best.end(), NoMatch);
+        for (const auto& match : tokens) {
+            for (DocId doc : vocabulary[match.first]->second.docs) {
+                best[doc] = std::min<uint8_t>(best[doc], static_cast<uint8_t>(match.second));
+            }
+        }
+        for (DocId doc = 0; doc < docCapacity(); ++doc) {
+            if (best[doc] == NoMatch) alive.reset(doc);
+            else totalDistance[doc] += best[doc];
+        }
+        if (!alive.any()) return results;
+    }
+
+    alive.forEach([&](uint32_t doc) {
+        results.push_back({doc, totalDistance[doc]});
+    });
+    std::stable_sort(results.begin(), results.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+        return a.distance < b.distance;
+    });
+    return results;
+}
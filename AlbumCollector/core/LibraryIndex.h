@@ -0,0 +1,83 @@
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "DocBitmap.h"
+#include "SpotifyClient.h"
+
+// In-memory inverted index over album names and artists. Each album gets a
+// dense document id that stays fixed while it is in the library, so
+// filters can be kept as DocBitmaps regardless of how the view is sorted.
+class LibraryIndex {
+public:
+    using DocId = uint32_t;
+    static constexpr DocId InvalidDoc = UINT32_MAX;
+
+    // Indexes the album (replacing any previous entry for its id)
+    DocId add(const Album& album);
+    void remove(const std::string& albumId);
+    void clear();
+
+    DocId docId(const std::string& albumId) const;
+    const std::string& albumId(DocId doc) const { return docAlbumIds[doc]; }
+
+    // Upper bound on document ids, i.e. the size bitmaps need to be
+    DocId docCapacity() const { return static_cast<DocId>(docAlbumIds.size()); }
+    int albumCount() const { return static_cast<int>(ids.size()); }
+
+    // Every document currently in the library
+    DocBitmap allDocs() const;
+
+    // Albums where every query word is a prefix of some word in the album's
+    // name or artist, so the result narrows as the user types
+    DocBitmap search(const QString& query) const;
+
+    struct FuzzyMatch {
+        DocId doc;
+        int distance;  // Summed over query words
+    };
+
+    // Typo-tolerant search: every query word must be within a small edit
+    // distance of a prefix of some album word ("radiohed" finds Radiohead).
+    // Candidates come from a trigram index over the vocabulary and are
+    // verified with a bounded edit distance; best matches first.
+    std::vector<FuzzyMatch> fuzzySearch(const QString& query) const;
+
+    // Casefolded words with diacritics stripped ("Björk" -> "bjork")
+    static QStringList tokenize(const QString& text);
+
+    // Edits allowed for a query word of this length (0 for short words)
+    static int maxEditsFor(int length);
+
+private:
+    std::unordered_map<std::string, DocId> ids;
+    std::vector<std::string> docAlbumIds;
+    std::vector<QStringList> docTokens;  // Needed to unlink a doc on removal
+    std::vector<DocId> freeDocs;
+
+    struct Posting {
+        std::vector<DocId> docs;
+        uint32_t tokenId;
+    };
+    using PostingMap = std::map<QString, Posting>;
+
+    // Sorted by token so a prefix maps to one contiguous range
+    PostingMap postings;
+
+    // Vocabulary for fuzzy matching: token id -> posting, and trigram ->
+    // sorted ids of the tokens containing it
+    std::vector<PostingMap::iterator> vocabulary;
+    std::vector<uint32_t> freeTokenIds;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> trigramPostings;
+
+    PostingMap::iterator addToken(const QString& token);
+    void removeToken(PostingMap::iterator posting);
+    static std::vector<uint64_t> trigrams(const QString& word);
+};
+
+#endif // LIBRARYINDEX_H
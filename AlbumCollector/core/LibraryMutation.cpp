@@ -0,0 +1,121 @@
+#include "LibraryMutation.h"
+#include <algorithm>
+
+namespace {
+
+// Final positions of kept rows given as positions among the kept albums
+// alone, once the albums at the ascending positions in added are in
+void shiftPastAdded(std::vector<int>& rows, const std::vector<int>& added)
+{
+    size_t before = 0;
+    for (int& row : rows) {
+        while (before < added.size() && added[before] <= row + int(before)) ++before;
+        row += int(before);
+    }
+}
+
+} // namespace
+
+void LibraryMutation::add(const LibraryAlbum& libAlbum, int position)
+{
+    additions.push_back({position, libAlbum});
+}
+
+void LibraryMutation::remove(const std::string& albumId)
+{
+    changes[albumId].remove = true;
+}
+
+void LibraryMutation::setRating(const std::string& albumId, int rating)
+{
+    changes[albumId].rating = rating;
+}
+
+void LibraryMutation::setCover(const std::string& albumId, const QByteArray& imageData,
+                               const ColorSignature& colors)
+{
+    Change& change = changes[albumId];
+    change.cover = imageData;
+    change.colors = colors;
+}
+
+// Kept albums slide down over removed ones as the pass goes, and additions
+// are merged in behind it, so the whole batch costs one walk over the
+// library plus the index work per album it names
+LibraryMutation::Applied LibraryMutation::apply(QVector<LibraryAlbum>& albums,
+                                                std::unordered_set<std::string>& albumIds,
+                                                LibraryIndex& index, LibraryFacets& facets,
+                                                LibraryMutation* inverse) const
+{
+    Applied applied;
+    LibraryMutation undo;
+
+    if (!changes.empty()) {
+        int kept = 0;
+        for (int row = 0; row < albums.size(); ++row) {
+            LibraryAlbum& libAlbum = albums[row];
+            auto it = changes.find(libAlbum.album.id);
+            if (it != changes.end()) {
+                const Change& change = it->second;
+                const LibraryIndex::DocId doc = index.docId(libAlbum.album.id);
+                if (change.remove) {
+                    if (doc != LibraryIndex::InvalidDoc) facets.remove(doc);
+                    index.remove(libAlbum.album.id);
+                    albumIds.erase(libAlbum.album.id);
+                    applied.removedRows.push_back(row);
+                    // Undone in ascending order, each lands where it was
+                    if (inverse) undo.add(libAlbum, row);
+                    continue;
+                }
+                if (change.rating && *change.rating != libAlbum.album.rating) {
+                    if (inverse) undo.setRating(libAlbum.album.id, libAlbum.album.rating);
+                    libAlbum.album.rating = *change.rating;
+                    if (doc != LibraryIndex::InvalidDoc) facets.setRating(doc, *change.rating);
+                    applied.ratedRows.push_back(kept);
+                }
+                if (change.cover) {
+                    if (inverse) undo.setCover(libAlbum.album.id, libAlbum.imageData, libAlbum.colors);
+                    libAlbum.imageData = *change.cover;
+                    libAlbum.colors = change.colors;
+                    applied.coverRows.push_back(kept);
+                }
+            }
+            if (kept != row) albums[kept] = std::move(libAlbum);
+            ++kept;
+        }
+        albums.erase(albums.begin() + kept, albums.end());
+    }
+
+    if (!additions.empty()) {
+        std::vector<const Addition*> order;
+        order.reserve(additions.size());
+        for (const Addition& addition : additions) order.push_back(&addition);
+        std::stable_sort(order.begin(), order.end(), [](const Addition* a, const Addition* b) {
+            return a->position < b->position;
+        });
+
+        QVector<LibraryAlbum> merged;
+        merged.reserve(albums.size() + int(additions.size()));
+        int next = 0;
+        for (const Addition* addition : order) {
+            const Album& album = addition->libAlbum.album;
+            if (!albumIds.insert(album.id).second) continue;
+            while (merged.size() < addition->position && next < albums.size()) {
+                merged.append(std::move(albums[next++]));
+            }
+            facets.add(index.add(album), album);
+            applied.addedRows.push_back(int(merged.size()));
+            if (inverse) undo.remove(album.id);
+            merged.append(addition->libAlbum);
+        }
+        if (!applied.addedRows.empty()) {
+            while (next < albums.size()) merged.append(std::move(albums[next++]));
+            albums = std::move(merged);
+            shiftPastAdded(applied.ratedRows, applied.addedRows);
+            shiftPastAdded(applied.coverRows, applied.addedRows);
+        }
+    }
+
+    if (inverse) *inverse = std::move(undo);
+    return applied;
+}
@@ -0,0 +1,73 @@
+#ifndef LIBRARYMUTATION_H
+#define LIBRARYMUTATION_H
+
+#include <QByteArray>
+#include <QVector>
+#include <climits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "LibraryFacets.h"
+#include "LibraryIndex.h"
+#include "LibraryStore.h"
+
+// A batch of changes to library albums, keyed by album id, applied in a
+// single pass over the library. However many albums it touches, the index
+// and facets are updated incrementally and the caller gets back one
+// description of what changed, so views and storage are updated once.
+// Ids no longer in the library are skipped, so a batch built up in the
+// background stays safe to apply.
+//
+// Applying a mutation can also produce its inverse, holding only what the
+// change overwrote: ids to take out again, old ratings, and removed albums
+// whose covers are shared rather than copied. That is what undo keeps.
+class LibraryMutation {
+public:
+    // Goes in at position in the resulting library, or at the end when
+    // position is past it; albums already in the library are skipped
+    void add(const LibraryAlbum& libAlbum, int position = INT_MAX);
+    void remove(const std::string& albumId);
+    void setRating(const std::string& albumId, int rating);
+    // colors belong to the cover; an invalid signature is worked out again
+    void setCover(const std::string& albumId, const QByteArray& imageData,
+                  const ColorSignature& colors = ColorSignature());
+
+    bool isEmpty() const { return changes.empty() && additions.empty(); }
+    int size() const { return int(changes.size() + additions.size()); }
+
+    struct Applied {
+        std::vector<int> removedRows;  // Positions before the change, ascending
+        std::vector<int> ratedRows;    // Positions after it, ascending
+        std::vector<int> coverRows;    // Positions after it, ascending
+        std::vector<int> addedRows;    // Positions after it, ascending
+
+        bool isEmpty() const {
+            return removedRows.empty() && ratedRows.empty() && coverRows.empty() && addedRows.empty();
+        }
+    };
+
+    // When inverse is given it is replaced with the mutation that undoes
+    // this one
+    Applied apply(QVector<LibraryAlbum>& albums, std::unordered_set<std::string>& albumIds,
+                  LibraryIndex& index, LibraryFacets& facets, LibraryMutation* inverse = nullptr) const;
+
+private:
+    struct Change {
+        bool remove = false;
+        std::optional<int> rating;
+        std::optional<QByteArray> cover;
+        ColorSignature colors;
+    };
+
+    struct Addition {
+        int position;
+        LibraryAlbum libAlbum;
+    };
+
+    std::unordered_map<std::string, Change> changes;
+    std::vector<Addition> additions;
+};
+
+#endif // LIBRARYMUTATION_H
@@ -0,0 +1,109 @@
+#include "LibrarySort.h"
+#include <QDate>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+void sortLibraryAlbums(QVector<LibraryAlbum>& albums, LibrarySortMode mode)
+{
+    switch (mode) {
+        case SortByArtist:
+            std::sort(albums.begin(), albums.end(),
+                [](const LibraryAlbum& a, const LibraryAlbum& b) {
+                    QString artistA = QString::fromStdString(a.album.artist).toLower();
+                    QString artistB = QString::fromStdString(b.album.artist).toLower();
+                    
+                    if (artistA == artistB) {
+                        // If same artist, sort by release date (newest first)
+                        QDate dateA = QDate::fromString(QString::fromStdString(a.album.release_date), "yyyy-MM-dd");
+                        QDate dateB = QDate::fromString(QString::fromStdString(b.album.release_date), "yyyy-MM-dd");
+                        if (!dateA.isValid() || !dateB.isValid()) {
+                            return a.album.release_date > b.album.release_date;
+                        }
+                        return dateA > dateB;
+                    }
+                    return artistA < artistB;
+                });
+            break;
+            
+        case SortByAlbumName:
+            std::sort(albums.begin(), albums.end(),
+                [](const LibraryAlbum& a, const LibraryAlbum& b) {
+                    return QString::fromStdString(a.album.name).toLower() < 
+                           QString::fromStdString(b.album.name).toLower();
+                });
+            break;
+            
+        case SortByReleaseDate:
+            std::sort(albums.begin(), albums.end(),
+                [](const LibraryAlbum& a, const LibraryAlbum& b) {
+                    QDate dateA = QDate::fromString(QString::fromStdString(a.album.release_date), "yyyy-MM-dd");
+                    QDate dateB = QDate::fromString(QString::fromStdString(b.album.release_date), "yyyy-MM-dd");
+                    if (!dateA.isValid() || !dateB.isValid()) {
+                        return a.album.release_date < b.album.release_date;
+                    }
+                    return dateA < dateB;
+                });
+            break;
+            
+        case SortByRating: // Highest to lowest
+            std::sort(albums.begin(), albums.end(),
+                [](const LibraryAlbum& a, const LibraryAlbum& b) {
+                    // Put unrated albums at the bottom
+                    if (a.album.rating == 0 && b.album.rating > 0) return false;
+                    if (b.album.rating == 0 && a.album.rating > 0) return true;
+                    
+                    // Sort by rating (highest to lowest)
+                    if (a.album.rating != b.album.rating) {
+                        return a.album.rating > b.album.rating;
+                    }
+                    
+                    // If ratings are equal, sort by artist name
+                    return QString::fromStdString(a.album.artist).toLower() < 
+                           QString::fromStdString(b.album.artist).toLower();
+                });
+            break;
+
+        case SortByColor:  // Needs a colour, see sortLibraryAlbumsByColor
+            break;
+    }
+}
+
+namespace {
+
+// Decorate-sort-undecorate: one key per album, then a stable sort of
+// (key, index) pairs so ties keep the current order
+template <typename Key>
+void sortByKey(QVector<LibraryAlbum>& albums, Key key)
+{
+    std::vector<std::pair<double, int>> keyed;
+    keyed.reserve(albums.size());
+    for (int i = 0; i < albums.size(); ++i) {
+        keyed.emplace_back(albums[i].colors.valid ? key(albums[i].colors)
+                                                  : std::numeric_limits<double>::max(), i);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+        [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+            return a.first < b.first;
+        });
+
+    QVector<LibraryAlbum> sorted;
+    sorted.reserve(albums.size());
+    for (const auto& entry : keyed) sorted.push_back(std::move(albums[entry.second]));
+    albums = std::move(sorted);
+}
+
+} // namespace
+
+void sortLibraryAlbumsByColor(QVector<LibraryAlbum>& albums, uint32_t rgb)
+{
+    sortByKey(albums, [rgb](const ColorSignature& colors) { return colors.distanceTo(rgb); });
+}
+
+void sortLibraryAlbumsBySimilarity(QVector<LibraryAlbum>& albums, const ColorSignature& reference)
+{
+    sortByKey(albums, [&reference](const ColorSignature& colors) {
+        return double(colors.distance(reference));
+    });
+}
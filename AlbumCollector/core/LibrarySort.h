@@ -0,0 +1,24 @@
+#ifndef LIBRARYSORT_H
+#define LIBRARYSORT_H
+
+#include <QVector>
+#include "LibraryStore.h"
+
+// Matches the order of the library page's "Sort by" combo box
+enum LibrarySortMode {
+    SortByArtist = 0,       // Then newest release first
+    SortByAlbumName = 1,
+    SortByReleaseDate = 2,  // Oldest first
+    SortByRating = 3,       // Highest first, unrated last
+    SortByColor = 4         // See sortLibraryAlbumsByColor
+};
+
+void sortLibraryAlbums(QVector<LibraryAlbum>& albums, LibrarySortMode mode);
+
+// Covers nearest the colour (0xRRGGBB) first, or nearest the reference
+// cover's colours; albums without a colour signature go last. Each key is
+// computed once, so this costs little more than sorting integers.
+void sortLibraryAlbumsByColor(QVector<LibraryAlbum>& albums, uint32_t rgb);
+void sortLibraryAlbumsBySimilarity(QVector<LibraryAlbum>& albums, const ColorSignature& reference);
+
+#endif // LIBRARYSORT_H
@@ -0,0 +1,151 @@
+#include "LibraryStore.h"
+#include "AlbumStream.h"
+#include "Metrics.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+LibraryStore::LibraryStore(const QString& filePath)
+    : filePath(filePath)
+{
+}
+
+QString LibraryStore::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/library.dat";
+}
+
+void LibraryStore::writeRecord(QDataStream& out, const LibraryAlbum& libAlbum)
+{
+    out << QString::fromStdString(libAlbum.album.name)
+        << QString::fromStdString(libAlbum.album.artist)
+        << QString::fromStdString(libAlbum.album.id)
+        << QString::fromStdString(libAlbum.album.release_date)
+        << QString::fromStdString(libAlbum.album.image_url)
+        << libAlbum.imageData
+        << qint32(libAlbum.album.rating);  // Explicitly save as qint32
+
+    out << libAlbum.album.details;
+    out << libAlbum.album.images;
+    out << libAlbum.colors;
+    out << qint32(libAlbum.album.details.failedAttempts) << qint64(libAlbum.album.details.lastAttempt);
+}
+
+LibraryAlbum LibraryStore::readRecord(QDataStream& in, quint32 version)
+{
+    QString name, artist, id, release_date, image_url;
+    QByteArray imageData;
+    qint32 rating = 0;  // Use qint32 for consistency
+
+    in >> name >> artist >> id >> release_date >> image_url >> imageData;
+
+    if (version >= 2) {
+        in >> rating;
+    }
+
+    Album album(name.toStdString(), artist.toStdString(),
+                id.toStdString(), release_date.toStdString(),
+                image_url.toStdString());
+    album.rating = rating;
+
+    if (version >= 3) {
+        in >> album.details;
+    }
+    if (version >= 4) {
+        in >> album.images;
+    }
+    LibraryAlbum libAlbum(album, imageData);
+    if (version >= 5) {
+        in >> libAlbum.colors;
+    }
+    if (version >= 6) {
+        qint32 failedAttempts = 0;
+        qint64 lastAttempt = 0;
+        in >> failedAttempts >> lastAttempt;
+        libAlbum.album.details.failedAttempts = failedAttempts;
+        libAlbum.album.details.lastAttempt = lastAttempt;
+    }
+    return libAlbum;
+}
+
+bool LibraryStore::save(const QVector<LibraryAlbum>& albums) const
+{
+    static Counter& saves = Metrics::counter("library.saves");
+    static Histogram& saveTime = Metrics::histogram("library.saveUs");
+    if (damaged) return false;
+    QElapsedTimer timer;
+    timer.start();
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    // Written beside the old file and renamed over it on commit, so a crash
+    // or a full disk mid-write leaves the previous library intact
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+
+    out << Magic << Version;
+    out << quint32(albums.size());
+
+    for (const auto& libAlbum : albums) {
+        writeRecord(out, libAlbum);
+    }
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        file.commit();
+        return false;
+    }
+    if (!file.commit()) return false;
+
+    saves.add();
+    saveTime.record(timer.nsecsElapsed() / 1000);
+    return true;
+}
+
+bool LibraryStore::load(QVector<LibraryAlbum>& albums) const
+{
+    Reader reader(filePath);
+    if (!reader.isOpen()) return false;
+
+    QVector<LibraryAlbum> loaded;
+    loaded.reserve(qMin<quint32>(reader.count(), 1u << 20));
+    LibraryAlbum libAlbum(Album("", "", "", "", ""), QByteArray());
+    while (reader.next(libAlbum)) {
+        loaded.append(std::move(libAlbum));
+    }
+    // next() stops both at the end and at a damaged record
+    if (quint32(loaded.size()) < reader.count()) {
+        damaged = true;
+        return false;
+    }
+
+    albums = std::move(loaded);
+    return true;
+}
+
+LibraryStore::Reader::Reader(const QString& filePath)
+    : file(filePath)
+{
+    if (!file.open(QIODevice::ReadOnly)) return;
+    in.setDevice(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic;
+    in >> magic >> version;
+    if (magic != Magic) return;
+    in >> size;
+    open = in.status() == QDataStream::Ok;
+}
+
+bool LibraryStore::Reader::next(LibraryAlbum& libAlbum)
+{
+    if (!open || read >= size || in.status() != QDataStream::Ok) return false;
+    libAlbum = readRecord(in, version);
+    ++read;
+    return in.status() == QDataStream::Ok;
+}
@@ -0,0 +1,76 @@
+#ifndef LIBRARYSTORE_H
+#define LIBRARYSTORE_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include "ColorSignature.h"
+#include "SpotifyClient.h"
+
+// A library entry: the album plus its cover art as stored on disk
+struct LibraryAlbum {
+    Album album;
+    QByteArray imageData;
+    ColorSignature colors;  // Filled in the background after the album is added
+    LibraryAlbum(const Album& a, const QByteArray& img)
+        : album(a), imageData(img) {}
+};
+
+// Reads and writes library.dat, the QDataStream file holding the library
+class LibraryStore {
+public:
+    static const quint32 Magic = 0x41434D47;
+    static const quint32 Version = 6;  // Version 6 adds enrichment attempts
+
+    explicit LibraryStore(const QString& filePath);
+
+    // library.dat in the application data directory
+    static QString defaultPath();
+
+    const QString& path() const { return filePath; }
+
+    // Refuses (returns false) once load() has found the file damaged
+    bool save(const QVector<LibraryAlbum>& albums) const;
+
+    // Replaces albums with the file's contents. Returns false (leaving
+    // albums untouched) when the file is missing, not a library file, or
+    // damaged: fewer records read than its header promises. A damaged file
+    // is never overwritten, so what it still holds can be recovered.
+    bool load(QVector<LibraryAlbum>& albums) const;
+    bool isDamaged() const { return damaged; }
+
+    // Single-record (de)serialisation, shared with anything that streams
+    // the file instead of loading it whole
+    static void writeRecord(QDataStream& out, const LibraryAlbum& libAlbum);
+    static LibraryAlbum readRecord(QDataStream& in, quint32 version);
+
+    // Reads the file one record at a time, so only the current album's
+    // cover is ever in memory
+    class Reader {
+    public:
+        explicit Reader(const QString& filePath);
+
+        // False when the file is missing or not a library file
+        bool isOpen() const { return open; }
+        quint32 count() const { return size; }
+
+        // The next record, or false at the end or on a damaged file
+        bool next(LibraryAlbum& libAlbum);
+
+    private:
+        QFile file;
+        QDataStream in;
+        bool open = false;
+        quint32 version = 0;
+        quint32 size = 0;
+        quint32 read = 0;
+    };
+
+private:
+    QString filePath;
+    mutable bool damaged = false;
+};
+
+#endif // LIBRARYSTORE_H
@@ -0,0 +1,111 @@
+#include "Metrics.h"
+#include <algorithm>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+std::mutex Metrics::registryMutex;
+
+int Histogram::bucketOf(uint64_t value)
+{
+    if (value < SubBuckets) return int(value);
+    const int exponent = 63 - __builtin_clzll(value);  // >= 3
+    const int shift = exponent - 3;
+    return SubBuckets + shift * SubBuckets + int((value >> shift) & (SubBuckets - 1));
+}
+
+uint64_t Histogram::bucketMidpoint(int bucket)
+{
+    if (bucket < SubBuckets) return uint64_t(bucket);
+    const int shift = (bucket - SubBuckets) / SubBuckets;
+    const uint64_t sub = uint64_t((bucket - SubBuckets) % SubBuckets);
+    const uint64_t low = (SubBuckets + sub) << shift;
+    return low + ((uint64_t(1) << shift) >> 1);
+}
+
+void Histogram::record(uint64_t value)
+{
+    buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    valueSum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t previous = valueMax.load(std::memory_order_relaxed);
+    while (previous < value &&
+           !valueMax.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::percentile(double q) const
+{
+    // Concurrent updates may land mid-scan; the result is still a value
+    // some recent sample fell into
+    uint64_t counts[BucketCount];
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        seen += counts[i];
+    }
+    if (seen == 0) return 0;
+
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::clamp(q, 0.0, 1.0) * seen + 0.5));
+    uint64_t cumulative = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        cumulative += counts[i];
+        if (cumulative >= rank) return std::min(bucketMidpoint(i), max());
+    }
+    return max();
+}
+
+template <typename Metric>
+Metric& Metrics::lookup(Family<Metric>& family, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = std::find(family.names.begin(), family.names.end(), name);
+    if (it != family.names.end()) return family.metrics[it - family.names.begin()];
+    family.names.push_back(name);
+    return family.metrics.emplace_back();
+}
+
+Counter& Metrics::counter(const std::string& name)
+{
+    static Family<Counter> counters;
+    return lookup(counters, name);
+}
+
+Gauge& Metrics::gauge(const std::string& name)
+{
+    static Family<Gauge> gauges;
+    return lookup(gauges, name);
+}
+
+Histogram& Metrics::histogram(const std::string& name)
+{
+    static Family<Histogram> histograms;
+    return lookup(histograms, name);
+}
+
+uint64_t Metrics::residentMemoryBytes()
+{
+#if defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#elif defined(__linux__)
+    // Second field of statm is resident pages
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long long size = 0, resident = 0;
+    const int fields = std::fscanf(file, "%llu %llu", &size, &resident);
+    std::fclose(file);
+    return fields == 2 ? resident * uint64_t(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
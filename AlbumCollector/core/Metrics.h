@@ -0,0 +1,87 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Process-wide counters, gauges and histograms. Registration takes a lock
+// once; updates are relaxed atomics and safe from any thread. Call sites
+// keep the returned reference in a function-local static:
+//
+//   static Counter& saves = Metrics::counter("library.saves");
+//   saves.add();
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value{0};
+};
+
+// Log-linear buckets: exact below 8, then 8 buckets per power of two, so
+// percentiles are within ~6% of the true value. Values are unitless; the
+// app records microseconds.
+class Histogram {
+public:
+    void record(uint64_t value);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return valueSum.load(std::memory_order_relaxed); }
+    uint64_t max() const { return valueMax.load(std::memory_order_relaxed); }
+    // q in [0, 1]; 0 when empty
+    uint64_t percentile(double q) const;
+
+private:
+    static constexpr int SubBuckets = 8;
+    static constexpr int BucketCount = SubBuckets + 61 * SubBuckets;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketMidpoint(int bucket);
+
+    std::array<std::atomic<uint64_t>, BucketCount> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> valueSum{0};
+    std::atomic<uint64_t> valueMax{0};
+};
+
+class Metrics {
+public:
+    // Returns the metric registered under name, creating it on first use.
+    // References stay valid for the life of the process.
+    static Counter& counter(const std::string& name);
+    static Gauge& gauge(const std::string& name);
+    static Histogram& histogram(const std::string& name);
+
+    // Resident set size of this process, 0 where unsupported
+    static uint64_t residentMemoryBytes();
+
+private:
+    template <typename Metric>
+    struct Family {
+        std::deque<Metric> metrics;   // deque: growth never moves elements
+        std::vector<std::string> names;
+    };
+
+    template <typename Metric>
+    static Metric& lookup(Family<Metric>& family, const std::string& name);
+
+    static std::mutex registryMutex;
+};
+
+#endif // METRICS_H
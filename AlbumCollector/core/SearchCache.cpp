@@ -0,0 +1,197 @@
+#include "SearchCache.h"
+#include "AlbumStream.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+const quint32 CacheMagic = 0x41435343;
+const quint32 CacheVersion = 2;  // Version 2 adds cover renditions
+}
+
+SearchCache::SearchCache(const QString& filePath)
+    : filePath(filePath)
+{
+}
+
+QString SearchCache::pageKey(const QString& query, int offset)
+{
+    return query.simplified().toCaseFolded() + QLatin1Char('\n') + QString::number(offset);
+}
+
+void SearchCache::storePage(const QString& query, int offset, const SpotifyClient::SearchResult& result)
+{
+    Page page;
+    page.total = result.total;
+    for (const auto& album : result.albums) {
+        page.albumIds.push_back(album.id);
+
+        // Keep enrichment and rating-free metadata from the newest sighting
+        auto it = albums.find(album.id);
+        if (it == albums.end()) {
+            albums.emplace(album.id, album);
+        } else if (!it->second.details.enriched) {
+            it->second = album;
+        }
+    }
+
+    QString key = pageKey(query, offset);
+    pageOrder.removeOne(key);
+    pageOrder.append(key);
+    pages.insert(key, page);
+    evictPages();
+    dirty = true;
+}
+
+bool SearchCache::lookupPage(const QString& query, int offset, SpotifyClient::SearchResult& result) const
+{
+    auto it = pages.constFind(pageKey(query, offset));
+    if (it == pages.constEnd()) return false;
+
+    result.albums.clear();
+    for (const auto& id : it->albumIds) {
+        auto album = albums.find(id);
+        if (album != albums.end()) result.albums.push_back(album->second);
+    }
+    result.total = it->total;
+    result.nextOffset = offset + static_cast<int>(it->albumIds.size());
+    result.hasMore = result.nextOffset < result.total;
+    result.succeeded = true;
+    return true;
+}
+
+bool SearchCache::searchLocal(const QString& query, int offset, int limit, SpotifyClient::SearchResult& result) const
+{
+    const QStringList words = query.toCaseFolded().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    if (words.isEmpty()) return false;
+
+    std::vector<const Album*> matches;
+    for (const auto& entry : albums) {
+        const Album& album = entry.second;
+        QString haystack = QString::fromStdString(album.name + " " + album.artist).toCaseFolded();
+        bool all = std::all_of(words.begin(), words.end(), [&haystack](const QString& word) {
+            return haystack.contains(word);
+        });
+        if (all) matches.push_back(&album);
+    }
+    if (matches.empty()) return false;
+
+    std::sort(matches.begin(), matches.end(), [](const Album* a, const Album* b) {
+        return a->artist != b->artist ? a->artist < b->artist : a->name < b->name;
+    });
+
+    result.albums.clear();
+    for (int i = offset; i < static_cast<int>(matches.size()) && i < offset + limit; ++i) {
+        result.albums.push_back(*matches[i]);
+    }
+    result.total = static_cast<int>(matches.size());
+    result.nextOffset = offset + static_cast<int>(result.albums.size());
+    result.hasMore = result.nextOffset < result.total;
+    result.succeeded = true;
+    return !result.albums.empty();
+}
+
+void SearchCache::evictPages()
+{
+    if (pageOrder.size() <= MaxPages) return;
+
+    while (pageOrder.size() > MaxPages) {
+        pages.remove(pageOrder.takeFirst());
+    }
+
+    // Drop albums no remaining page refers to
+    std::unordered_set<std::string> referenced;
+    for (const Page& page : pages) {
+        referenced.insert(page.albumIds.begin(), page.albumIds.end());
+    }
+    for (auto it = albums.begin(); it != albums.end();) {
+        if (referenced.count(it->first)) ++it;
+        else it = albums.erase(it);
+    }
+}
+
+bool SearchCache::load()
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != CacheMagic || version > CacheVersion) return false;
+
+    pages.clear();
+    pageOrder.clear();
+    albums.clear();
+
+    quint32 albumCount;
+    in >> albumCount;
+    for (quint32 i = 0; i < albumCount && in.status() == QDataStream::Ok; ++i) {
+        QString name, artist, id, release_date, image_url;
+        in >> name >> artist >> id >> release_date >> image_url;
+        Album album(name.toStdString(), artist.toStdString(), id.toStdString(),
+                    release_date.toStdString(), image_url.toStdString());
+        in >> album.details;
+        if (version >= 2) in >> album.images;
+        albums.emplace(album.id, album);
+    }
+
+    quint32 pageCount;
+    in >> pageCount;
+    for (quint32 i = 0; i < pageCount && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        QStringList ids;
+        qint32 total;
+        in >> key >> ids >> total;
+
+        Page page;
+        page.albumIds = toStdVector(ids);
+        page.total = total;
+        pages.insert(key, page);
+        pageOrder.append(key);
+    }
+
+    dirty = false;
+    return in.status() == QDataStream::Ok;
+}
+
+bool SearchCache::save()
+{
+    if (!dirty) return true;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CacheMagic << CacheVersion;
+
+    out << quint32(albums.size());
+    for (const auto& entry : albums) {
+        const Album& album = entry.second;
+        out << QString::fromStdString(album.name)
+            << QString::fromStdString(album.artist)
+            << QString::fromStdString(album.id)
+            << QString::fromStdString(album.release_date)
+            << QString::fromStdString(album.image_url)
+            << album.details
+            << album.images;
+    }
+
+    out << quint32(pageOrder.size());
+    for (const QString& key : pageOrder) {
+        const Page& page = pages[key];
+        out << key << toQStringList(page.albumIds) << qint32(page.total);
+    }
+
+    if (!file.commit()) return false;
+    dirty = false;
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef SEARCHCACHE_H
+#define SEARCHCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <unordered_map>
+#include "SpotifyClient.h"
+
+// Local store of every album and search page seen from the API. Lets the
+// app answer searches instantly, and at all when offline, while live results
+// are fetched in the background.
+class SearchCache {
+public:
+    explicit SearchCache(const QString& filePath);
+
+    bool load();
+    bool save();
+
+    // Remembers a live result page and the albums on it
+    void storePage(const QString& query, int offset, const SpotifyClient::SearchResult& result);
+
+    // Exact page previously returned by the API for this query and offset
+    bool lookupPage(const QString& query, int offset, SpotifyClient::SearchResult& result) const;
+
+    // Fallback for queries never sent online: matches every query word
+    // against the names and artists of all stored albums
+    bool searchLocal(const QString& query, int offset, int limit, SpotifyClient::SearchResult& result) const;
+
+    int albumCount() const { return static_cast<int>(albums.size()); }
+
+private:
+    struct Page {
+        std::vector<std::string> albumIds;
+        int total = 0;
+    };
+
+    static const int MaxPages = 2000;
+
+    QString filePath;
+    QHash<QString, Page> pages;
+    QStringList pageOrder;  // Oldest first, for eviction
+    std::unordered_map<std::string, Album> albums;
+    bool dirty = false;
+
+    static QString pageKey(const QString& query, int offset);
+    void evictPages();
+};
+
+#endif // SEARCHCACHE_H
@@ -0,0 +1,586 @@
+#ifndef SPOTIFYCLIENT_H
+#define SPOTIFYCLIENT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "Metrics.h"
+#include "Trace.h"
+#include "/opt/homebrew/Cellar/nlohmann-json/3.11.3/include/nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// Extra metadata that only the full album object carries. Filled in by the
+// background enrichment pass, which fetches albums 20 at a time.
+struct AlbumDetails {
+    bool enriched = false;
+    int total_tracks = 0;
+    std::vector<std::string> artists;
+    std::string label;
+    std::vector<std::string> genres;
+
+    // Passes that asked for the album and got nothing back, either because
+    // the request failed or because the API returned null for the id, and
+    // when the last one was (seconds since the epoch). Each failure doubles
+    // the wait before the album is asked for again.
+    int failedAttempts = 0;
+    int64_t lastAttempt = 0;
+
+    static constexpr int64_t RetryBaseSeconds = 15 * 60;
+    static constexpr int64_t RetryMaxSeconds = 7 * 24 * 3600;
+
+    bool enrichmentDue(int64_t now) const {
+        if (enriched) return false;
+        if (failedAttempts == 0) return true;
+        int64_t wait = RetryBaseSeconds << std::min(failedAttempts - 1, 20);
+        return now - lastAttempt >= std::min(wait, RetryMaxSeconds);
+    }
+};
+
+// One size of an album's cover art. Spotify usually offers 640, 300 and 64
+// pixel squares; the dimensions can be 0 when the API leaves them null.
+struct ImageRendition {
+    std::string url;
+    int width = 0;
+    int height = 0;
+};
+
+// Album class to store album information
+class Album {
+public:
+    std::string name;
+    std::string artist;
+    std::string id;
+    std::string release_date;
+    std::string image_url;  // Largest rendition, kept for older records
+    int rating;
+    AlbumDetails details;
+    std::vector<ImageRendition> images;
+
+    Album(const std::string& name, const std::string& artist, const std::string& id,
+          const std::string& release_date, const std::string& image_url)
+        : name(name), artist(artist), id(id), release_date(release_date), image_url(image_url), rating(0) {}
+
+    // Smallest rendition that is at least pixels wide, or the largest one
+    // when none is. Unknown sizes only win when nothing else is known.
+    const std::string& imageUrlFor(int pixels) const {
+        const ImageRendition* best = nullptr;
+        const ImageRendition* largest = nullptr;
+        for (const auto& image : images) {
+            if (!largest || image.width > largest->width) largest = &image;
+            if (image.width >= pixels && (!best || image.width < best->width)) best = &image;
+        }
+        if (best) return best->url;
+        if (largest) return largest->url;
+        return image_url;
+    }
+};
+
+// Byte accounting for HTTP transfers. wireBytes is what actually crossed the
+// network (headers plus the possibly compressed body), decodedBytes is the
+// body after content decoding, so the ratio shows what compression saved.
+struct TransferStats {
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> http2Requests{0};
+    std::atomic<uint64_t> wireBytes{0};
+    std::atomic<uint64_t> decodedBytes{0};
+
+    void record(uint64_t wire, uint64_t decoded, bool http2) {
+        static Counter& downloaded = Metrics::counter("network.wireBytes");
+        downloaded.add(wire);
+        requests.fetch_add(1, std::memory_order_relaxed);
+        if (http2) http2Requests.fetch_add(1, std::memory_order_relaxed);
+        wireBytes.fetch_add(wire, std::memory_order_relaxed);
+        decodedBytes.fetch_add(decoded, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        requests = 0;
+        http2Requests = 0;
+        wireBytes = 0;
+        decodedBytes = 0;
+    }
+};
+
+// Token bucket shared by every API call, so nothing trips Spotify's 429
+// limit. Interactive calls (the user's searches) have priority: background
+// calls (enrichment, imports) wait while one is waiting and leave a few
+// tokens in the bucket, so a search typed mid-import goes out at once.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Priority { Interactive, Background };
+
+    // Tokens only interactive calls may take
+    static constexpr double InteractiveReserve = 2.0;
+
+    RateLimiter(double requestsPerSecond, double burst)
+        : rate(requestsPerSecond), capacity(burst), tokens(burst), last(Clock::now()), blockedUntil(last) {}
+
+    // Blocks the calling thread until a request may be sent. Returns false
+    // once cancel() has been called, however long the wait would have been.
+    bool acquire(Priority priority = Priority::Interactive) {
+        std::unique_lock<std::mutex> lock(mutex);
+        const bool interactive = priority == Priority::Interactive;
+        if (interactive) ++interactiveWaiting;
+        const bool granted = take(lock, interactive);
+        if (interactive && --interactiveWaiting == 0) wake.notify_all();
+        return granted;
+    }
+
+    // Releases every waiting and future acquire(), e.g. at shutdown
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        wake.notify_all();
+    }
+
+    // Called when the server answers 429; nobody sends until Retry-After passes
+    void backoff(std::chrono::seconds retryAfter) {
+        std::lock_guard<std::mutex> lock(mutex);
+        blockedUntil = std::max(blockedUntil, Clock::now() + retryAfter);
+        tokens = 0.0;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool cancelled = false;
+    int interactiveWaiting = 0;
+    double rate;
+    double capacity;
+    double tokens;
+    Clock::time_point last;
+    Clock::time_point blockedUntil;
+
+    bool take(std::unique_lock<std::mutex>& lock, bool interactive) {
+        const double needed = interactive ? 1.0 : 1.0 + std::min(InteractiveReserve, capacity - 1.0);
+        for (;;) {
+            if (cancelled) return false;
+            Clock::time_point now = Clock::now();
+            if (now < blockedUntil) {
+                wake.wait_until(lock, blockedUntil);
+                continue;
+            }
+            if (!interactive && interactiveWaiting > 0) {
+                wake.wait(lock);  // Woken when the last interactive call is through
+                continue;
+            }
+            tokens = std::min(capacity, tokens + std::chrono::duration<double>(now - last).count() * rate);
+            last = now;
+            if (tokens >= needed) {
+                tokens -= 1.0;
+                return true;
+            }
+            wake.wait_for(lock, std::chrono::duration<double>((needed - tokens) / rate));
+        }
+    }
+};
+
+// Change the WriteCallback function to be inline
+inline size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
+    userp->append((char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+class SpotifyClient {
+public:
+    // Where requests go. Overridable so the client can be pointed at a
+    // local mock server (tools/mockspotify) for reproducible measurements.
+    struct Endpoints {
+        std::string accountsUrl = "https://accounts.spotify.com";
+        std::string apiUrl = "https://api.spotify.com";
+
+        // Defaults, overridden by ALBUMCOLLECTOR_ACCOUNTS_URL and
+        // ALBUMCOLLECTOR_API_URL when set
+        static Endpoints fromEnvironment() {
+            Endpoints endpoints;
+            if (const char* url = std::getenv("ALBUMCOLLECTOR_ACCOUNTS_URL")) endpoints.accountsUrl = url;
+            if (const char* url = std::getenv("ALBUMCOLLECTOR_API_URL")) endpoints.apiUrl = url;
+            return endpoints;
+        }
+    };
+
+private:
+    Endpoints endpoints;
+    std::string client_id;
+    std::string client_secret;
+    std::string access_token;
+    std::mutex authMutex;
+
+    // Shared connection cache, DNS cache and TLS sessions, so consecutive
+    // requests reuse one (HTTP/2) connection instead of a fresh handshake
+    CURLSH* share = nullptr;
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+    TransferStats stats;
+    RateLimiter limiter{10.0, 10.0};
+    std::atomic<bool> aborting{false};
+
+    // Whole-transfer deadline, and the stall after which a transfer that
+    // still trickles in is given up on
+    static constexpr long TransferTimeoutSeconds = 30;
+    static constexpr long StallSeconds = 10;
+
+    // Progress callback: a non-zero return makes libcurl abort the transfer
+    static int abortCheck(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+        return static_cast<SpotifyClient*>(clientp)->aborting ? 1 : 0;
+    }
+
+    static void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+        static_cast<SpotifyClient*>(userp)->shareLocks[data].lock();
+    }
+
+    static void unlockShare(CURL*, curl_lock_data data, void* userp) {
+        static_cast<SpotifyClient*>(userp)->shareLocks[data].unlock();
+    }
+
+    void setupShare() {
+        share = curl_share_init();
+        if (!share) return;
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+
+    // Options common to every request. HTTP/2 is negotiated over TLS via ALPN
+    // and silently falls back to HTTP/1.1 when the server or the libcurl build
+    // lacks it; an empty Accept-Encoding offers every decoder libcurl was built
+    // with (gzip, deflate, br, zstd) and falls back to identity. No transfer
+    // outlives its deadline, a stall or abortTransfers().
+    void configureTransfer(CURL* curl, const std::string& url, curl_slist* headers, std::string* response) {
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, TransferTimeoutSeconds);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, StallSeconds);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abortCheck);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+        if (share) curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    }
+
+    void recordTransfer(CURL* curl, const std::string& response) {
+        curl_off_t body = 0;
+        long header = 0;
+        long httpVersion = 0;
+        curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &body);
+        curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &header);
+        curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &httpVersion);
+        stats.record(static_cast<uint64_t>(body) + static_cast<uint64_t>(header),
+                     response.size(), httpVersion == CURL_HTTP_VERSION_2_0);
+    }
+
+    // Make WriteCallback a static member function
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
+        userp->append(static_cast<char*>(contents), size * nmemb);
+        return size * nmemb;
+    }
+
+    // Base64 encoding helper function can remain as a private member
+    std::string base64_encode(const std::string& input) const {
+        static const std::string base64_chars = 
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        
+        std::string encoded;
+        int val = 0, valb = -6;
+        for (unsigned char c : input) {
+            val = (val << 8) + c;
+            valb += 8;
+            while (valb >= 0) {
+                encoded.push_back(base64_chars[(val >> valb) & 0x3F]);
+                valb -= 6;
+            }
+        }
+        if (valb > -6) encoded.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
+        while (encoded.size() % 4) encoded.push_back('=');
+        return encoded;
+    }
+
+    // Rate-limited authenticated GET. Retries a few times on 429, honouring
+    // the Retry-After header. Returns false on transport or HTTP errors.
+    bool apiGet(const std::string& url, std::string& response,
+                RateLimiter::Priority priority = RateLimiter::Priority::Interactive) {
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            std::string token;
+            if (!bearerToken(token)) return false;
+
+            if (!limiter.acquire(priority)) return false;
+
+            CURL* curl = curl_easy_init();
+            if (!curl) return false;
+
+            response.clear();
+            struct curl_slist* headers = nullptr;
+            std::string auth_header = "Authorization: Bearer " + token;
+            headers = curl_slist_append(headers, auth_header.c_str());
+
+            configureTransfer(curl, url, headers, &response);
+
+            CURLcode res = curl_easy_perform(curl);
+            long status = 0;
+            curl_off_t retryAfter = 0;
+            if (res == CURLE_OK) {
+                recordTransfer(curl, response);
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+                curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfter);
+            }
+            curl_slist_free_all(headers);
+            curl_easy_cleanup(curl);
+
+            if (res != CURLE_OK) return false;
+            if (status == 429) {
+                limiter.backoff(std::chrono::seconds(std::max<curl_off_t>(retryAfter, 1)));
+                continue;
+            }
+            if (status == 401) {
+                // Client-credentials tokens expire after an hour
+                invalidateToken(token);
+                continue;
+            }
+            return status < 400;
+        }
+        return false;
+    }
+
+    // Authenticates on first use rather than in the constructor, so the app
+    // can start and serve cached data without network access
+    bool bearerToken(std::string& token) {
+        std::lock_guard<std::mutex> lock(authMutex);
+        if (access_token.empty() && !authenticate()) return false;
+        token = access_token;
+        return true;
+    }
+
+    void invalidateToken(const std::string& token) {
+        std::lock_guard<std::mutex> lock(authMutex);
+        if (access_token == token) access_token.clear();
+    }
+
+    // Works for both the simplified album objects in search results and the
+    // full objects from /v1/albums; the latter also carry label and genres.
+    static Album parseAlbum(const json& album, bool fullObject) {
+        std::vector<ImageRendition> renditions;
+        for (const auto& image : album.at("images")) {
+            ImageRendition rendition;
+            rendition.url = image.at("url").get<std::string>();
+            if (image.contains("width") && image["width"].is_number()) rendition.width = image["width"].get<int>();
+            if (image.contains("height") && image["height"].is_number()) rendition.height = image["height"].get<int>();
+            renditions.push_back(std::move(rendition));
+        }
+        std::string image_url;
+        if (!renditions.empty()) image_url = renditions[0].url;
+        std::string artist_name = album.at("artists")[0].at("name").get<std::string>();
+
+        Album result(album.at("name").get<std::string>(),
+                     artist_name,
+                     album.at("id").get<std::string>(),
+                     album.at("release_date").get<std::string>(),
+                     image_url);
+        result.images = std::move(renditions);
+        if (!result.images.empty()) result.image_url = result.imageUrlFor(INT_MAX);
+
+        result.details.total_tracks = album.value("total_tracks", 0);
+        for (const auto& artist : album.at("artists")) {
+            result.details.artists.push_back(artist.at("name").get<std::string>());
+        }
+        if (fullObject) {
+            result.details.label = album.value("label", std::string());
+            result.details.genres = album.value("genres", std::vector<std::string>());
+            result.details.enriched = true;
+        }
+        return result;
+    }
+
+    bool authenticate() {
+        if (aborting) return false;
+        CURL* curl = curl_easy_init();
+        if (!curl) return false;
+
+        // Prepare the authorization header
+        std::string auth_str = client_id + ":" + client_secret;
+        std::string auth_header = "Authorization: Basic " + base64_encode(auth_str);
+        
+        // Set up the POST request
+        std::string response;
+        struct curl_slist* headers = nullptr;
+        headers = curl_slist_append(headers, auth_header.c_str());
+        headers = curl_slist_append(headers, "Content-Type: application/x-www-form-urlencoded");
+
+        configureTransfer(curl, endpoints.accountsUrl + "/api/token", headers, &response);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "grant_type=client_credentials");
+
+        CURLcode res = curl_easy_perform(curl);
+        if (res == CURLE_OK) recordTransfer(curl, response);
+        curl_slist_free_all(headers);
+        curl_easy_cleanup(curl);
+
+        if (res != CURLE_OK) return false;
+
+        try {
+            json j = json::parse(response);
+            access_token = j.at("access_token").get<std::string>();
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+public:
+    SpotifyClient(const std::string& id, const std::string& secret,
+                  const Endpoints& endpoints = Endpoints::fromEnvironment())
+        : endpoints(endpoints), client_id(id), client_secret(secret) {
+        setupShare();
+    }
+
+    ~SpotifyClient() {
+        if (share) curl_share_cleanup(share);
+    }
+
+    SpotifyClient(const SpotifyClient&) = delete;
+    SpotifyClient& operator=(const SpotifyClient&) = delete;
+
+    // Ends every transfer in flight and fails every later request, so
+    // threads using the client can be waited for at shutdown
+    void abortTransfers() {
+        aborting = true;
+        limiter.cancel();
+    }
+
+    // Cumulative byte counters for every request made through this client
+    TransferStats& transferStats() { return stats; }
+
+    struct SearchResult {
+        std::vector<Album> albums;
+        int total;
+        bool hasMore;
+        int nextOffset;
+        bool succeeded;  // false when the request or parsing failed (e.g. offline)
+    };
+
+    // Parses one page of /v1/search?type=album. Static so recorded responses
+    // can be parsed (and benchmarked) without a client or network.
+    static SearchResult parseSearchResponse(const std::string& response, int offset) {
+        SearchResult result;
+        result.total = 0;
+        result.hasMore = false;
+        result.nextOffset = offset;
+        result.succeeded = false;
+
+        try {
+            json albumsJson = json::parse(response).at("albums");
+            json items = albumsJson.at("items");
+            
+            // Get total number of results
+            result.total = albumsJson.at("total").get<int>();
+            
+            // Calculate if there are more results
+            int limit = albumsJson.at("limit").get<int>();
+            result.nextOffset = offset + limit;
+            result.hasMore = result.nextOffset < result.total;
+
+            for (const auto& album : items) {
+                result.albums.push_back(parseAlbum(album, false));
+            }
+            result.succeeded = true;
+        } catch (...) {
+            // Handle parsing errors
+        }
+        return result;
+    }
+
+    // Parses a /v1/albums?ids= response; null entries (unknown ids) are
+    // skipped. ok, when given, is cleared if the response could not be parsed.
+    static std::vector<Album> parseSeveralAlbumsResponse(const std::string& response, bool* ok = nullptr) {
+        std::vector<Album> albums;
+        if (ok) *ok = true;
+        try {
+            json parsed = json::parse(response);
+            for (const auto& album : parsed.at("albums")) {
+                if (album.is_null()) continue;
+                albums.push_back(parseAlbum(album, true));
+            }
+        } catch (...) {
+            albums.clear();
+            if (ok) *ok = false;
+        }
+        return albums;
+    }
+
+    // Background callers (imports) pass Priority::Background so the user's
+    // own searches go first
+    SearchResult searchAlbums(const std::string& query, int offset = 0,
+                              RateLimiter::Priority priority = RateLimiter::Priority::Interactive) {
+        TRACE_SPAN("searchAlbums", "network");
+        SearchResult result;
+        result.albums.clear();
+        result.total = 0;
+        result.hasMore = false;
+        result.nextOffset = offset;
+        result.succeeded = false;
+
+        CURL* curl = curl_easy_init();
+        if (!curl) return result;
+
+        char* encoded_query = curl_easy_escape(curl, query.c_str(), static_cast<int>(query.length()));
+        std::string url = endpoints.apiUrl + "/v1/search?q=" + 
+                         std::string(encoded_query) + 
+                         "&type=album&limit=10&offset=" + 
+                         std::to_string(offset);
+        curl_free(encoded_query);
+        curl_easy_cleanup(curl);
+
+        std::string response;
+        if (apiGet(url, response, priority)) {
+            result = parseSearchResponse(response, offset);
+        }
+
+        return result;
+    }
+
+    // The several-albums endpoint accepts at most this many ids per call
+    static constexpr size_t MaxAlbumsPerRequest = 20;
+
+    // Fetches full album objects for up to MaxAlbumsPerRequest ids in one
+    // request, at background priority. Returns false when the request itself
+    // failed, so callers can tell ids worth retrying soon from ids the API
+    // returned null for (which are simply missing from albums).
+    bool getSeveralAlbums(const std::vector<std::string>& ids, std::vector<Album>& albums) {
+        TRACE_SPAN("getSeveralAlbums", "network");
+        albums.clear();
+        if (ids.empty()) return true;
+
+        std::string url = endpoints.apiUrl + "/v1/albums?ids=";
+        for (size_t i = 0; i < ids.size() && i < MaxAlbumsPerRequest; ++i) {
+            if (i > 0) url += ",";
+            url += ids[i];
+        }
+
+        std::string response;
+        if (!apiGet(url, response, RateLimiter::Priority::Background)) return false;
+
+        bool ok = false;
+        albums = parseSeveralAlbumsResponse(response, &ok);
+        return ok;
+    }
+};
+
+#endif // SPOTIFYCLIENT_H 
\ No newline at end of file
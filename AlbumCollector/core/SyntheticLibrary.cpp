@@ -0,0 +1,92 @@
+#include "SyntheticLibrary.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const char* const Syllables[] = {
+    "ra", "dio", "head", "bea", "tles", "zep", "pe", "lin", "mo", "on",
+    "kid", "a", "ok", "com", "pu", "ter", "blur", "ox", "is", "sto",
+    "nes", "pink", "floyd", "wall", "dark", "side", "bjö", "rk", "mú", "sic",
+    "vel", "vet", "un", "der", "ground", "sig", "ur", "rós", "por", "tis"
+};
+const int SyllableCount = sizeof(Syllables) / sizeof(Syllables[0]);
+
+} // namespace
+
+std::string SyntheticLibrary::makeTitle(Random& random, int minWords, int maxWords)
+{
+    std::string title;
+    int words = minWords + random.below(maxWords - minWords + 1);
+    for (int w = 0; w < words; ++w) {
+        if (w > 0) title += ' ';
+        std::string word;
+        for (int s = 2 + random.below(2); s > 0; --s) word += Syllables[random.below(SyllableCount)];
+        word[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(word[0])));
+        title += word;
+    }
+    return title;
+}
+
+std::string SyntheticLibrary::makeId(Random& random)
+{
+    // Spotify ids are 22 base-62 characters
+    static const char alphabet[] =
+        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    std::string id(22, '0');
+    for (char& c : id) c = alphabet[random.below(62)];
+    return id;
+}
+
+QVector<LibraryAlbum> SyntheticLibrary::generate(const Options& options, const ImageFactory& image)
+{
+    Random random(options.seed);
+
+    const int artistCount = std::max(1, options.artistCount > 0 ? options.artistCount
+                                                                 : options.albumCount / 8);
+    std::vector<std::string> artists;
+    artists.reserve(artistCount);
+    for (int i = 0; i < artistCount; ++i) {
+        artists.push_back(makeTitle(random, 1, 2));
+    }
+
+    // Cumulative Zipf weights, sampled by binary search
+    std::vector<double> cumulative(artistCount);
+    double sum = 0.0;
+    for (int rank = 0; rank < artistCount; ++rank) {
+        sum += 1.0 / std::pow(rank + 1.0, options.artistSkew);
+        cumulative[rank] = sum;
+    }
+
+    QVector<LibraryAlbum> albums;
+    albums.reserve(options.albumCount);
+    for (int i = 0; i < options.albumCount; ++i) {
+        double pick = random.unit() * sum;
+        int artist = static_cast<int>(std::lower_bound(cumulative.begin(), cumulative.end(), pick)
+                                      - cumulative.begin());
+        artist = std::min(artist, artistCount - 1);
+
+        // Mostly full dates, some year-only like older Spotify releases
+        char date[16];
+        int year = 1955 + random.below(70);
+        if (random.below(10) == 0) {
+            std::snprintf(date, sizeof(date), "%04d", year);
+        } else {
+            std::snprintf(date, sizeof(date), "%04d-%02d-%02d",
+                          year, 1 + random.below(12), 1 + random.below(28));
+        }
+
+        std::string id = makeId(random);
+        Album album(makeTitle(random, 1, 4), artists[artist], id, date,
+                    "https://i.scdn.co/image/ab67616d0000b273" + id);
+        album.rating = random.unit() < options.unratedShare ? 0 : 1 + random.below(10);
+        album.details.total_tracks = 6 + random.below(14);
+        album.details.artists.push_back(album.artist);
+        album.details.enriched = true;  // Nothing to fetch for made-up ids
+
+        albums.append(LibraryAlbum(album, image ? image(i) : QByteArray()));
+    }
+    return albums;
+}
@@ -0,0 +1,51 @@
+#ifndef SYNTHETICLIBRARY_H
+#define SYNTHETICLIBRARY_H
+
+#include <QByteArray>
+#include <QVector>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "LibraryStore.h"
+
+// Deterministic generator of realistic-looking libraries for benchmarks and
+// scale testing. The same options always produce the same albums on every
+// platform (no std distributions, whose output is implementation-defined).
+class SyntheticLibrary {
+public:
+    struct Options {
+        int albumCount = 1000;
+        int artistCount = 0;        // 0 picks albumCount / 8
+        double artistSkew = 1.1;    // Zipf exponent: a few prolific artists, a long tail
+        double unratedShare = 0.4;  // Albums left at rating 0
+        uint32_t seed = 42;
+    };
+
+    // Cover art for album `index`; empty by default so metadata-only
+    // benchmarks stay light. Encoding images needs QtGui, which core
+    // does not link, so callers supply the bytes.
+    using ImageFactory = std::function<QByteArray(int index)>;
+
+    static QVector<LibraryAlbum> generate(const Options& options,
+                                          const ImageFactory& image = ImageFactory());
+
+private:
+    // xorshift32; tiny, fast and identical everywhere
+    struct Random {
+        uint32_t state;
+        explicit Random(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+        uint32_t next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+        int below(int n) { return static_cast<int>(next() % static_cast<uint32_t>(n)); }
+        double unit() { return next() / 4294967296.0; }
+    };
+
+    static std::string makeTitle(Random& random, int minWords, int maxWords);
+    static std::string makeId(Random& random);
+};
+
+#endif // SYNTHETICLIBRARY_H
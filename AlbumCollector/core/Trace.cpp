@@ -0,0 +1,94 @@
+#include "Trace.h"
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    int64_t start;
+    int64_t duration;
+    uint32_t thread;
+};
+
+std::mutex eventsMutex;
+std::vector<Event> events;
+std::string outputPath;
+
+// Small sequential ids read better in the viewer than hashed thread ids
+uint32_t currentThreadId()
+{
+    static std::atomic<uint32_t> nextId{1};
+    thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void writeEscaped(std::ofstream& out, const char* text)
+{
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') out << '\\';
+        out << *text;
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Trace::active{false};
+
+void Trace::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    outputPath = path;
+    events.clear();
+    events.reserve(1 << 16);
+    active.store(true, std::memory_order_relaxed);
+}
+
+void Trace::startFromEnvironment()
+{
+    const char* path = std::getenv("ALBUMCOLLECTOR_TRACE");
+    if (path && *path) start(path);
+}
+
+void Trace::complete(const char* name, const char* category, int64_t start, int64_t duration)
+{
+    const uint32_t thread = currentThreadId();
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    if (!active.load(std::memory_order_relaxed)) return;
+    events.push_back({name, category, start, duration, thread});
+}
+
+bool Trace::stop()
+{
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    if (!active.exchange(false)) return true;
+
+    std::ofstream out(outputPath, std::ios::trunc);
+    if (!out) return false;
+
+    // Timestamps relative to the first event keep the numbers short
+    int64_t origin = events.empty() ? 0 : events.front().start;
+    for (const Event& event : events) origin = std::min(origin, event.start);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        out << "{\"name\":\"";
+        writeEscaped(out, event.name);
+        out << "\",\"cat\":\"";
+        writeEscaped(out, event.category);
+        out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << (event.start - origin)
+            << ",\"dur\":" << event.duration << '}'
+            << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    events.clear();
+    events.shrink_to_fit();
+    return bool(out);
+}
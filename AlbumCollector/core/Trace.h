@@ -0,0 +1,64 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped trace spans written as Chrome trace-event JSON, which both
+// chrome://tracing and ui.perfetto.dev open. Off by default; when off a
+// span costs one relaxed atomic load. Enable with ALBUMCOLLECTOR_TRACE=<file>
+// or the app's --trace <file> flag; events are written by Trace::stop().
+//
+//   void MainWindow::sortLibrary(int mode) {
+//       TRACE_SPAN("sortLibrary");
+//       ...
+//   }
+
+class Trace {
+public:
+    // Starts collecting; stop() writes everything to path
+    static void start(const std::string& path);
+    // Calls start() with $ALBUMCOLLECTOR_TRACE if set
+    static void startFromEnvironment();
+    // Writes the collected events and stops collecting. Returns false if
+    // the file could not be written.
+    static bool stop();
+
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    // Microseconds on the steady clock, the trace timebase
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // name and category must outlive the trace (string literals)
+    static void complete(const char* name, const char* category, int64_t start, int64_t duration);
+
+private:
+    static std::atomic<bool> active;
+};
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "app")
+        : name(name), category(category), start(Trace::enabled() ? Trace::now() : -1) {}
+    ~TraceSpan() {
+        if (start >= 0) Trace::complete(name, category, start, Trace::now() - start);
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    int64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(...) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
+
+#endif // TRACE_H
@@ -0,0 +1,9 @@
+# Include from any project that links the core library
+
+CORE_OUT_PWD = $$shadowed($$PWD)
+
+INCLUDEPATH += $$PWD \
+    /opt/homebrew/Cellar/nlohmann-json/3.11.3/include
+
+LIBS += -L$$CORE_OUT_PWD -lcore -lcurl
+PRE_TARGETDEPS += $$CORE_OUT_PWD/libcore.a
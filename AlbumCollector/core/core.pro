@@ -0,0 +1,45 @@
+# Static library with everything that does not need a QApplication, so it
+# can be benchmarked and reused headless. The app and benchmarks link it
+# through core.pri.
+
+TEMPLATE = lib
+CONFIG += staticlib c++17
+
+QT = core
+
+TARGET = core
+
+SOURCES += \
+    SearchCache.cpp \
+    LibraryIndex.cpp \
+    LibraryFacets.cpp \
+    LibraryStore.cpp \
+    LibrarySort.cpp \
+    SyntheticLibrary.cpp \
+    Metrics.cpp \
+    Trace.cpp \
+    CoverHash.cpp \
+    ColorSignature.cpp \
+    LibraryImport.cpp \
+    LibraryExport.cpp \
+    LibraryMutation.cpp
+
+HEADERS += \
+    SpotifyClient.h \
+    AlbumStream.h \
+    SearchCache.h \
+    DocBitmap.h \
+    LibraryIndex.h \
+    LibraryFacets.h \
+    LibraryStore.h \
+    LibrarySort.h \
+    SyntheticLibrary.h \
+    Metrics.h \
+    Trace.h \
+    CoverHash.h \
+    ColorSignature.h \
+    LibraryImport.h \
+    LibraryExport.h \
+    LibraryMutation.h
+
+INCLUDEPATH += /opt/homebrew/Cellar/nlohmann-json/3.11.3/include
@@ -0,0 +1,41 @@
+#ifndef COVERTRANSFER_H
+#define COVERTRANSFER_H
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include "SpotifyClient.h"
+
+// Request setup and byte accounting shared by every cover download (search
+// rows, adds, re-fetches and imports)
+
+// HTTP/2 lets covers from the CDN share one multiplexed connection. JPEG
+// and PNG do not compress further, so covers are asked for without content
+// coding: QNAM then has nothing to decode, and the body read is the body
+// that crossed the network.
+inline QNetworkRequest coverRequest(const QString& url)
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setRawHeader("Accept-Encoding", "identity");
+    return request;
+}
+
+// Records a finished cover reply the way SpotifyClient records curl
+// transfers: wire bytes are the response headers plus the body as sent.
+// Headers are counted as HTTP/1.1 text, which slightly overstates HTTP/2's
+// compressed headers. Replies served from the disk cache never touched the
+// network and should not be recorded.
+inline void recordCoverTransfer(TransferStats& stats, QNetworkReply* reply, qint64 bodyBytes)
+{
+    const QByteArray statusLine = "HTTP/1.1 "
+        + reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toByteArray() + ' '
+        + reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray() + "\r\n";
+    uint64_t headerBytes = uint64_t(statusLine.size()) + 2;  // Blank line ends the headers
+    for (const auto& header : reply->rawHeaderPairs()) {
+        headerBytes += uint64_t(header.first.size() + header.second.size()) + 4;  // ": " and CRLF
+    }
+    stats.record(headerBytes + uint64_t(bodyBytes), uint64_t(bodyBytes),
+                 reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool());
+}
+
+#endif // COVERTRANSFER_H
@@ -0,0 +1,98 @@
+#include "duplicatesdialog.h"
+#include <QBuffer>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QImageReader>
+#include <QLabel>
+#include <QPixmap>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+#include "CoverHash.h"
+
+namespace {
+const int IconSize = 40;
+}
+
+DuplicatesDialog::DuplicatesDialog(const QVector<LibraryAlbum>& albums,
+                                   const std::vector<std::vector<int>>& groups,
+                                   const QString& summary, QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Possible Duplicates");
+    resize(520, 480);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    QLabel* summaryLabel = new QLabel(summary);
+    summaryLabel->setWordWrap(true);
+    layout->addWidget(summaryLabel);
+
+    tree = new QTreeWidget;
+    tree->setHeaderHidden(true);
+    tree->setIconSize(QSize(IconSize, IconSize));
+    tree->setUniformRowHeights(true);
+    layout->addWidget(tree, 1);
+
+    // Groups are few and small, so decoding their covers here is fine
+    const qreal dpr = devicePixelRatioF();
+    for (const auto& group : groups) {
+        const Album& first = albums[group.front()].album;
+        QTreeWidgetItem* groupItem = new QTreeWidgetItem(tree);
+        groupItem->setText(0, QString("%1 albums like \"%2\"")
+            .arg(group.size())
+            .arg(QString::fromStdString(first.name)));
+        groupItem->setFlags(Qt::ItemIsEnabled);
+
+        for (int albumIndex : group) {
+            const LibraryAlbum& libAlbum = albums[albumIndex];
+            QTreeWidgetItem* item = new QTreeWidgetItem(groupItem);
+            item->setText(0, QString("%1 - %2 (%3)")
+                .arg(QString::fromStdString(libAlbum.album.name))
+                .arg(QString::fromStdString(libAlbum.album.artist))
+                .arg(QString::fromStdString(libAlbum.album.release_date)));
+            item->setData(0, Qt::UserRole, QString::fromStdString(libAlbum.album.id));
+
+            QPixmap cover;
+            if (cover.loadFromData(libAlbum.imageData)) {
+                cover = cover.scaled(QSize(IconSize, IconSize) * dpr, Qt::KeepAspectRatio,
+                                     Qt::SmoothTransformation);
+                cover.setDevicePixelRatio(dpr);
+                item->setIcon(0, QIcon(cover));
+            }
+        }
+    }
+    tree->expandAll();
+
+    connect(tree, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem* item) {
+        QVariant albumId = item->data(0, Qt::UserRole);
+        if (albumId.isValid()) emit albumActivated(albumId.toString());
+    });
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+}
+
+quint64 DuplicatesDialog::hashCover(const QByteArray& encoded)
+{
+    QBuffer buffer;
+    buffer.setData(encoded);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    const QSize size = reader.size();
+    if (size.isValid() && size.width() > 64 && size.height() > 64) {
+        reader.setScaledSize(QSize(64, 64));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) return 0;
+
+    image = image.scaled(CoverHash::GridWidth, CoverHash::GridHeight,
+                         Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                 .convertToFormat(QImage::Format_Grayscale8);
+    uint8_t grid[CoverHash::GridWidth * CoverHash::GridHeight];
+    for (int y = 0; y < CoverHash::GridHeight; ++y) {
+        const uchar* line = image.constScanLine(y);
+        std::copy(line, line + CoverHash::GridWidth, grid + y * CoverHash::GridWidth);
+    }
+    return CoverHash::differenceHash(grid);
+}
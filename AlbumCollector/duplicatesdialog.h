@@ -0,0 +1,36 @@
+#ifndef DUPLICATESDIALOG_H
+#define DUPLICATESDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include <vector>
+#include "LibraryStore.h"
+
+class QTreeWidget;
+
+// Lists groups of library albums whose covers look alike: remasters,
+// deluxe editions and regional releases that reuse the same art.
+class DuplicatesDialog : public QDialog {
+    Q_OBJECT
+public:
+    // Groups hold indexes into albums, read only while the dialog is built
+    DuplicatesDialog(const QVector<LibraryAlbum>& albums,
+                     const std::vector<std::vector<int>>& groups,
+                     const QString& summary, QWidget* parent = nullptr);
+
+    // dHash of an encoded cover, 0 when it does not decode. Thread-safe;
+    // the decoder scales down while decoding, so this stays cheap.
+    static quint64 hashCover(const QByteArray& encoded);
+
+    // Covers this many bits apart or fewer count as the same art
+    static constexpr int MatchDistance = 6;
+
+signals:
+    // By id: the library can change (and re-sort) while the dialog is open
+    void albumActivated(const QString& albumId);
+
+private:
+    QTreeWidget* tree;
+};
+
+#endif // DUPLICATESDIALOG_H
@@ -0,0 +1,33 @@
+#include "eventloopmonitor.h"
+#include <QtGlobal>
+
+EventLoopMonitor::EventLoopMonitor(QObject* parent)
+    : QObject(parent)
+{
+    heartbeat.setTimerType(Qt::PreciseTimer);
+    heartbeat.setInterval(IntervalMs);
+    connect(&heartbeat, &QTimer::timeout, this, &EventLoopMonitor::tick);
+}
+
+void EventLoopMonitor::start()
+{
+    maxBlockNs = 0;
+    sinceTick.start();
+    heartbeat.start();
+}
+
+void EventLoopMonitor::stop()
+{
+    // The stretch since the last tick counts too; stop() is usually called
+    // at the end of the very work being measured
+    tick();
+    heartbeat.stop();
+}
+
+void EventLoopMonitor::tick()
+{
+    if (!sinceTick.isValid()) return;
+    const qint64 blocked = sinceTick.nsecsElapsed() - qint64(IntervalMs) * 1000000;
+    maxBlockNs = qMax(maxBlockNs, blocked);
+    sinceTick.restart();
+}
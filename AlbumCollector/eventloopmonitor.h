@@ -0,0 +1,33 @@
+#ifndef EVENTLOOPMONITOR_H
+#define EVENTLOOPMONITOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+// Measures how long the GUI thread goes without getting back to its event
+// loop. A precise 1 ms timer ticks while running; any gap between ticks
+// beyond the interval is time input could not have been handled.
+class EventLoopMonitor : public QObject {
+    Q_OBJECT
+public:
+    explicit EventLoopMonitor(QObject* parent = nullptr);
+
+    void start();
+    void stop();
+    bool isRunning() const { return heartbeat.isActive(); }
+
+    // Longest block seen since start(), in ms
+    double maxBlockMs() const { return maxBlockNs / 1e6; }
+
+private:
+    static constexpr int IntervalMs = 1;
+
+    QTimer heartbeat;
+    QElapsedTimer sinceTick;
+    qint64 maxBlockNs = 0;
+
+    void tick();
+};
+
+#endif // EVENTLOOPMONITOR_H
@@ -0,0 +1,177 @@
+#include "librarygrid.h"
+#include "thumbnailcache.h"
+#include <QPainter>
+#include <QResizeEvent>
+#include <QScrollBar>
+
+LibraryGridModel::LibraryGridModel(const QVector<LibraryAlbum>* albums, QObject* parent)
+    : QAbstractListModel(parent), albums(albums)
+{
+}
+
+void LibraryGridModel::setRows(QVector<int> newRows)
+{
+    beginResetModel();
+    rows = std::move(newRows);
+    endResetModel();
+}
+
+int LibraryGridModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant LibraryGridModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+    const Album& album = albumAt(index.row()).album;
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString::fromStdString(album.name);
+    case Qt::ToolTipRole:
+        return QString("%1 - %2").arg(QString::fromStdString(album.name),
+                                      QString::fromStdString(album.artist));
+    case AlbumIndexRole:
+        return rows[index.row()];
+    default:
+        return QVariant();
+    }
+}
+
+CoverDelegate::CoverDelegate(ThumbnailCache* cache, QObject* parent)
+    : QStyledItemDelegate(parent), cache(cache)
+{
+}
+
+void CoverDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                          const QModelIndex& index) const
+{
+    const auto* model = static_cast<const LibraryGridModel*>(index.model());
+    const LibraryAlbum& libAlbum = model->albumAt(index.row());
+    const QPalette& palette = option.palette;
+
+    painter->save();
+    if (option.state & QStyle::State_Selected) {
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(palette.color(QPalette::Highlight));
+        painter->drawRoundedRect(QRectF(option.rect), 4, 4);
+    }
+
+    const QRect coverRect(option.rect.left() + (option.rect.width() - CoverSize) / 2,
+                          option.rect.top() + Padding, CoverSize, CoverSize);
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    const QImage cover = cache->lookup(QString::fromStdString(libAlbum.album.id),
+                                       qRound(CoverSize * dpr), libAlbum.imageData);
+    if (cover.isNull()) {
+        painter->fillRect(coverRect, palette.color(QPalette::AlternateBase));
+    } else {
+        const QSize fitted = cover.size().scaled(coverRect.size(), Qt::KeepAspectRatio);
+        const QRect target(coverRect.left() + (CoverSize - fitted.width()) / 2,
+                           coverRect.top() + (CoverSize - fitted.height()) / 2,
+                           fitted.width(), fitted.height());
+        // Only stand-ins from another level need smoothing
+        painter->setRenderHint(QPainter::SmoothPixmapTransform,
+                               cover.width() != qRound(fitted.width() * dpr));
+        painter->drawImage(target, cover);
+    }
+
+    const QColor textColor = palette.color((option.state & QStyle::State_Selected)
+                                               ? QPalette::HighlightedText : QPalette::Text);
+    const QFontMetrics metrics(option.font);
+    QRect textRect(option.rect.left() + Padding, coverRect.bottom() + 1 + Padding / 2,
+                   option.rect.width() - 2 * Padding, metrics.height());
+    painter->setPen(textColor);
+    painter->setFont(option.font);
+    painter->drawText(textRect, Qt::AlignHCenter | Qt::AlignTop,
+        metrics.elidedText(QString::fromStdString(libAlbum.album.name), Qt::ElideRight, textRect.width()));
+
+    QColor artistColor = textColor;
+    artistColor.setAlpha(170);
+    painter->setPen(artistColor);
+    textRect.translate(0, metrics.height());
+    painter->drawText(textRect, Qt::AlignHCenter | Qt::AlignTop,
+        metrics.elidedText(QString::fromStdString(libAlbum.album.artist), Qt::ElideRight, textRect.width()));
+    painter->restore();
+}
+
+QSize CoverDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex&) const
+{
+    const QFontMetrics metrics(option.font);
+    return QSize(CoverSize + 2 * Padding, CoverSize + 2 * Padding + 2 * metrics.height());
+}
+
+LibraryGridView::LibraryGridView(ThumbnailCache* cache, QWidget* parent)
+    : QListView(parent), cache(cache)
+{
+    setViewMode(QListView::IconMode);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setUniformItemSizes(true);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setSpacing(4);
+    setItemDelegate(new CoverDelegate(cache, this));
+
+    // Coalesce bursts of scroll steps into one request per event-loop turn
+    wantedTimer.setSingleShot(true);
+    wantedTimer.setInterval(0);
+    connect(&wantedTimer, &QTimer::timeout, this, &LibraryGridView::updateWanted);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &LibraryGridView::scheduleWantedUpdate);
+
+    connect(cache, &ThumbnailCache::thumbnailReady, viewport(), [this]() {
+        viewport()->update();
+    });
+    connect(this, &QAbstractItemView::doubleClicked, this, [this](const QModelIndex& index) {
+        emit albumActivated(index.data(LibraryGridModel::AlbumIndexRole).toInt());
+    });
+}
+
+void LibraryGridView::setModel(QAbstractItemModel* model)
+{
+    QListView::setModel(model);
+    connect(model, &QAbstractItemModel::modelReset, this, &LibraryGridView::scheduleWantedUpdate);
+    scheduleWantedUpdate();
+}
+
+void LibraryGridView::resizeEvent(QResizeEvent* event)
+{
+    QListView::resizeEvent(event);
+    scheduleWantedUpdate();
+}
+
+// Cells are uniform, so the visible range follows from the scroll offset
+// without asking the layout about individual items
+void LibraryGridView::updateWanted()
+{
+    const auto* gridModel = qobject_cast<const LibraryGridModel*>(model());
+    if (!gridModel || gridModel->rowCount() == 0) return;
+
+    const QSize cell = sizeHintForIndex(gridModel->index(0)) + QSize(2 * spacing(), 2 * spacing());
+    const int columns = qMax(1, viewport()->width() / cell.width());
+    const int firstLine = verticalScrollBar()->value() / cell.height();
+    const int visibleLines = viewport()->height() / cell.height() + 2;
+    const int count = gridModel->rowCount();
+
+    const int first = qBound(0, firstLine * columns, count - 1);
+    const int last = qBound(0, (firstLine + visibleLines) * columns - 1, count - 1);
+    const int margin = last - first + 1;  // One screen each way
+
+    // Visible cells, then outwards: the screen below first, as scrolling
+    // down is the common case
+    QVector<int> order;
+    for (int row = first; row <= last; ++row) order.append(row);
+    for (int step = 1; step <= margin; ++step) {
+        if (last + step < count) order.append(last + step);
+        if (first - step >= 0) order.append(first - step);
+    }
+
+    QVector<ThumbnailCache::Request> wanted;
+    wanted.reserve(order.size());
+    for (int row : order) {
+        const LibraryAlbum& libAlbum = gridModel->albumAt(row);
+        wanted.append({QString::fromStdString(libAlbum.album.id), libAlbum.imageData});
+    }
+    cache->setWanted(wanted, qRound(CoverDelegate::CoverSize * devicePixelRatioF()));
+}
@@ -0,0 +1,78 @@
+#ifndef LIBRARYGRID_H
+#define LIBRARYGRID_H
+
+#include <QAbstractListModel>
+#include <QListView>
+#include <QStyledItemDelegate>
+#include <QTimer>
+#include <QVector>
+#include "LibraryStore.h"
+
+class ThumbnailCache;
+
+// Library albums that pass the current filter, in library order. Holds
+// indexes into MainWindow's libraryAlbums rather than copies.
+class LibraryGridModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles { AlbumIndexRole = Qt::UserRole };
+
+    LibraryGridModel(const QVector<LibraryAlbum>* albums, QObject* parent = nullptr);
+
+    // Replaces the shown albums; rows are indexes into the albums vector
+    void setRows(QVector<int> rows);
+    const LibraryAlbum& albumAt(int row) const { return (*albums)[rows[row]]; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    const QVector<LibraryAlbum>* albums;
+    QVector<int> rows;
+};
+
+// One cover cell: the cover scaled into a square, album and artist below
+class CoverDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    static constexpr int CoverSize = 150;
+    static constexpr int Padding = 6;
+
+    CoverDelegate(ThumbnailCache* cache, QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    ThumbnailCache* cache;
+};
+
+// Cover wall over LibraryGridModel. QListView in icon mode with uniform
+// cells lays out and paints only what is in the viewport, so 50k albums
+// cost no more per frame than 50. After every scroll or resize the view
+// tells the thumbnail cache which covers are visible or within one screen
+// of it, so decoding runs ahead of scrolling and memory follows the
+// viewport.
+class LibraryGridView : public QListView {
+    Q_OBJECT
+public:
+    LibraryGridView(ThumbnailCache* cache, QWidget* parent = nullptr);
+    void setModel(QAbstractItemModel* model) override;
+
+signals:
+    // Double-clicked; albumIndex indexes libraryAlbums
+    void albumActivated(int albumIndex);
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    ThumbnailCache* cache;
+    QTimer wantedTimer;
+
+    void scheduleWantedUpdate() { wantedTimer.start(); }
+    void updateWanted();
+};
+
+#endif // LIBRARYGRID_H
@@ -0,0 +1,244 @@
+#include "libraryimporter.h"
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "Trace.h"
+#include "covertransfer.h"
+
+LibraryImporter::LibraryImporter(SpotifyClient& spotify, TransferStats& imageStats, QObject* parent)
+    : QObject(parent)
+    , spotify(spotify)
+    , imageStats(imageStats)
+    , network(new QNetworkAccessManager(this))
+    , resolver(new QFutureWatcher<Resolution>(this))
+{
+    connect(resolver, &QFutureWatcher<Resolution>::finished, this, &LibraryImporter::resolved);
+    connect(network, &QNetworkAccessManager::finished, this, &LibraryImporter::downloaded);
+}
+
+LibraryImporter::~LibraryImporter()
+{
+    // The resolver uses the client and the journal
+    stop = true;
+    resolver->waitForFinished();
+}
+
+bool LibraryImporter::start(const QString& filePath, const std::unordered_set<std::string>& existing,
+                            QString* error)
+{
+    if (running) return false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    const std::vector<ImportEntry> entries = LibraryImport::parse(data);
+    if (entries.empty()) {
+        if (error) *error = "No album ids or artist/album pairs found.";
+        return false;
+    }
+
+    journal = std::make_unique<ImportJournal>(ImportJournal::pathFor(data));
+    const QHash<int, std::string> known = journal->load();
+    auto fetched = std::make_shared<std::unordered_map<std::string, ImportJournal::FetchedAlbum>>(
+        journal->loadAlbums());
+    stop = false;
+    running = true;
+    unresolved = 0;
+    failed = 0;
+    pending.clear();
+    emit progress(0, int(entries.size()), known.isEmpty()
+        ? QString("Looking up albums...")
+        : QString("Resuming, %1 lookups already done...").arg(known.size()));
+
+    ImportJournal* log = journal.get();
+    resolver->setFuture(QtConcurrent::run([this, entries, known, fetched, existing, log]() {
+        TRACE_SPAN("resolveImport", "network");
+        Resolution resolution;
+        const int total = int(entries.size());
+        auto report = [this](int done, int total, const QString& stage) {
+            QMetaObject::invokeMethod(this, [this, done, total, stage]() {
+                emit progress(done, total, stage);
+            }, Qt::QueuedConnection);
+        };
+
+        // Stage 1: ids for name pairs the journal does not know yet
+        std::vector<std::string> ids(entries.size());
+        std::vector<bool> lookupFailed(entries.size(), false);
+        std::vector<int> toSearch;
+        for (int i = 0; i < total; ++i) {
+            if (!entries[i].id.empty()) ids[i] = entries[i].id;
+            else if (known.contains(i)) ids[i] = known.value(i);
+            else toSearch.push_back(i);
+        }
+
+        QThreadPool searchPool;
+        searchPool.setMaxThreadCount(SearchConcurrency);
+        int done = total - int(toSearch.size());
+        const size_t chunkSize = 4 * SearchConcurrency;
+        for (size_t start = 0; start < toSearch.size() && !stop; start += chunkSize) {
+            const QVector<int> chunk(toSearch.begin() + start,
+                                     toSearch.begin() + std::min(toSearch.size(), start + chunkSize));
+            // (request succeeded, matching id) per entry
+            const QList<std::pair<bool, std::string>> found =
+                QtConcurrent::mapped(&searchPool, chunk, [this, &entries](int i) {
+                    const SpotifyClient::SearchResult result =
+                        spotify.searchAlbums(LibraryImport::searchQuery(entries[i]), 0,
+                                             RateLimiter::Priority::Background);
+                    const Album* match = LibraryImport::bestMatch(result.albums, entries[i]);
+                    return std::make_pair(result.succeeded, match ? match->id : std::string());
+                }).results();
+
+            // Failed requests (offline) are not journalled, so they are retried
+            for (int k = 0; k < chunk.size() && k < found.size(); ++k) {
+                ids[chunk[k]] = found[k].second;
+                if (found[k].first) log->record(chunk[k], found[k].second);
+                else lookupFailed[chunk[k]] = true;
+            }
+            done += int(chunk.size());
+            report(done, total, "Looking up albums...");
+        }
+
+        // Stage 2: full album objects, skipping repeats, library albums and
+        // albums the journal already holds
+        std::vector<std::string> fetch;
+        std::unordered_set<std::string> seen = existing;
+        for (int i = 0; i < total && !stop; ++i) {
+            const std::string& id = ids[i];
+            if (lookupFailed[i]) {
+                ++resolution.failed;
+            } else if (id.empty()) {
+                ++resolution.unresolved;
+            } else if (seen.insert(id).second) {
+                auto it = fetched->find(id);
+                if (it == fetched->end()) fetch.push_back(id);
+                else if (it->second.coverDone) resolution.covered.push_back(it->second.libAlbum);
+                else resolution.albums.push_back(it->second.libAlbum.album);
+            }
+        }
+
+        // A failed request says nothing about its ids; only nulls in a
+        // successful response mean the album does not exist
+        const size_t batchSize = SpotifyClient::MaxAlbumsPerRequest;
+        for (size_t i = 0; i < fetch.size() && !stop; i += batchSize) {
+            std::vector<std::string> batch(fetch.begin() + i,
+                                           fetch.begin() + std::min(fetch.size(), i + batchSize));
+            std::vector<Album> albums;
+            if (!spotify.getSeveralAlbums(batch, albums)) {
+                resolution.failed += int(batch.size());
+            } else {
+                resolution.unresolved += int(batch.size() - albums.size());
+            }
+            for (Album& album : albums) {
+                log->recordAlbum(LibraryAlbum(album, QByteArray()), false);
+                resolution.albums.push_back(std::move(album));
+            }
+            report(int(std::min(fetch.size(), i + batchSize)), int(fetch.size()), "Fetching album details...");
+        }
+        return resolution;
+    }));
+    return true;
+}
+
+void LibraryImporter::cancel()
+{
+    if (!running) return;
+    stop = true;
+    if (resolver->isRunning()) return;  // resolved() finishes up
+
+    // Aborted replies still finish, but are no longer ours to handle
+    const QList<QNetworkReply*> replies = downloads.keys();
+    downloads.clear();
+    for (QNetworkReply* reply : replies) reply->abort();
+    finish(true);
+}
+
+void LibraryImporter::commit()
+{
+    if (journal && failed == 0) journal->remove();
+}
+
+void LibraryImporter::resolved()
+{
+    if (stop) {
+        finish(true);
+        return;
+    }
+
+    Resolution resolution = resolver->result();
+    unresolved = resolution.unresolved;
+    failed = resolution.failed;
+    coverFailed.clear();
+    pending.reserve(int(resolution.covered.size() + resolution.albums.size()));
+    for (LibraryAlbum& libAlbum : resolution.covered) pending.append(std::move(libAlbum));
+    for (const Album& album : resolution.albums) pending.append(LibraryAlbum(album, QByteArray()));
+
+    // Stage 3: covers, a bounded number at a time. Journalled albums whose
+    // cover is already in lead the list and count as done.
+    nextDownload = int(resolution.covered.size());
+    downloadsDone = nextDownload;
+    emit progress(downloadsDone, pending.size(), "Downloading covers...");
+    downloadMore();
+}
+
+void LibraryImporter::downloadMore()
+{
+    while (downloads.size() < DownloadsInFlight && nextDownload < pending.size()) {
+        const int index = nextDownload++;
+        const QString url = QString::fromStdString(pending[index].album.imageUrlFor(CoverPixels));
+        if (url.isEmpty()) {
+            journal->recordAlbum(pending[index], true);
+            ++downloadsDone;
+            continue;
+        }
+        downloads.insert(network->get(coverRequest(url)), index);
+    }
+    if (downloadsDone == pending.size()) finish(false);
+}
+
+void LibraryImporter::downloaded(QNetworkReply* reply)
+{
+    reply->deleteLater();
+    auto it = downloads.find(reply);
+    if (it == downloads.end()) return;
+    const int index = it.value();
+    downloads.erase(it);
+
+    // Stored as downloaded: no decode or re-encode, and the sidecar and
+    // grid scale it down later anyway. A failed cover (offline, errors)
+    // keeps the album out of this import and counts as failed; its journal
+    // entry stays without a cover, so the next run downloads just that.
+    if (reply->error() == QNetworkReply::NoError) {
+        const QByteArray data = reply->readAll();
+        recordCoverTransfer(imageStats, reply, data.size());
+        pending[index].imageData = data;
+        journal->recordAlbum(pending[index], true);
+    } else {
+        coverFailed.insert(index);
+        ++failed;
+    }
+    ++downloadsDone;
+    emit progress(downloadsDone, pending.size(), "Downloading covers...");
+    downloadMore();
+}
+
+void LibraryImporter::finish(bool cancelled)
+{
+    if (!running) return;
+    running = false;
+    QVector<LibraryAlbum> albums;
+    if (!cancelled) {
+        albums.reserve(pending.size() - coverFailed.size());
+        for (int i = 0; i < pending.size(); ++i) {
+            if (!coverFailed.contains(i)) albums.append(std::move(pending[i]));
+        }
+    }
+    pending.clear();
+    coverFailed.clear();
+    emit finished(albums, unresolved, failed, cancelled);
+}
@@ -0,0 +1,89 @@
+#ifndef LIBRARYIMPORTER_H
+#define LIBRARYIMPORTER_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <unordered_set>
+#include "LibraryImport.h"
+#include "LibraryStore.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Turns an import file into finished library entries in three stages:
+//  1. name pairs are searched a few at a time, ids taken as they are;
+//  2. full album objects come from the several-albums endpoint, 20 per call;
+//  3. covers download with a bounded number in flight.
+// The client's rate limiter paces every API call, at background priority
+// so the user's own searches go first. Lookups, fetched albums and
+// downloaded covers are journalled as they happen, so running the same file
+// again after a crash or cancel skips straight past what was already done.
+// Nothing touches the library until finished(), which hands over
+// everything at once.
+class LibraryImporter : public QObject {
+    Q_OBJECT
+public:
+    LibraryImporter(SpotifyClient& spotify, TransferStats& imageStats, QObject* parent = nullptr);
+    ~LibraryImporter();
+
+    // Albums whose ids are in existing are left out. Returns false with a
+    // message when the file cannot be read or holds nothing to import.
+    bool start(const QString& filePath, const std::unordered_set<std::string>& existing,
+               QString* error);
+    void cancel();
+    bool isRunning() const { return running; }
+
+    // Call once the albums are safely in the library. The journal stays
+    // while requests failed, so the same file retries just those.
+    void commit();
+
+signals:
+    void progress(int done, int total, const QString& stage);
+    // unresolved counts entries the API has no album for; failed counts
+    // entries whose requests failed (offline, errors) and are worth a
+    // retry. After a cancel albums is empty, but the journal keeps what
+    // was resolved.
+    void finished(const QVector<LibraryAlbum>& albums, int unresolved, int failed, bool cancelled);
+
+private:
+    static const int SearchConcurrency = 4;
+    static const int DownloadsInFlight = 12;
+    // Covers are stored at the grid's largest cell size
+    static const int CoverPixels = 300;
+
+    struct Resolution {
+        std::vector<LibraryAlbum> covered;  // From the journal, cover done
+        std::vector<Album> albums;          // Still need their cover
+        int unresolved = 0;
+        int failed = 0;
+    };
+
+    SpotifyClient& spotify;
+    TransferStats& imageStats;
+    QNetworkAccessManager* network;
+    std::unique_ptr<ImportJournal> journal;
+    std::atomic<bool> stop{false};
+    QFutureWatcher<Resolution>* resolver;
+    bool running = false;
+    int unresolved = 0;
+    int failed = 0;
+
+    QVector<LibraryAlbum> pending;  // Resolved, waiting for or holding art
+    QSet<int> coverFailed;          // Pending rows whose cover did not download
+    int nextDownload = 0;
+    int downloadsDone = 0;
+    QHash<QNetworkReply*, int> downloads;
+
+    void resolved();
+    void downloadMore();
+    void downloaded(QNetworkReply* reply);
+    void finish(bool cancelled);
+};
+
+#endif // LIBRARYIMPORTER_H
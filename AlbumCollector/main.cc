@@ -1,6 +1,12 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include "mainwindow.h"
+#include "scaletest.h"
+#include "startuptimer.h"
+#include "themestyle.h"
+#include "Trace.h"
 
 class Application : public QApplication {
 public:
@@ -24,12 +30,58 @@ public:
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer sinceStart;
+    sinceStart.start();
+
     try {
         curl_global_init(CURL_GLOBAL_DEFAULT);
         Application app(argc, argv);
-        
-        MainWindow window;
+        app.setStyle(new ThemeStyle);  // Themes are palettes drawn by this style
+        StartupTimer startup(sinceStart);
+        startup.mark("application");
+
+        QCommandLineParser parser;
+        parser.addHelpOption();
+        QCommandLineOption scaleTestOption("scale-test",
+            "Load <library> instead of the user's library, time load, first paint, "
+            "sorting and scrolling, then exit.", "library");
+        QCommandLineOption scaleReportOption("scale-report",
+            "Also write the scale test timings as JSON to <file>.", "file");
+        QCommandLineOption apiUrlOption("api-url",
+            "Send Web API requests to <url> instead of api.spotify.com.", "url");
+        QCommandLineOption accountsUrlOption("accounts-url",
+            "Request tokens from <url> instead of accounts.spotify.com.", "url");
+        QCommandLineOption traceOption("trace",
+            "Record trace spans and write them as Chrome trace JSON to <file> on exit "
+            "(same as ALBUMCOLLECTOR_TRACE=<file>).", "file");
+        parser.addOptions({scaleTestOption, scaleReportOption, apiUrlOption, accountsUrlOption,
+                           traceOption});
+        parser.process(app);
+
+        if (parser.isSet(traceOption)) {
+            Trace::start(parser.value(traceOption).toStdString());
+        } else {
+            Trace::startFromEnvironment();
+        }
+
+        // SpotifyClient picks these up when MainWindow constructs it
+        if (parser.isSet(apiUrlOption)) {
+            qputenv("ALBUMCOLLECTOR_API_URL", parser.value(apiUrlOption).toUtf8());
+        }
+        if (parser.isSet(accountsUrlOption)) {
+            qputenv("ALBUMCOLLECTOR_ACCOUNTS_URL", parser.value(accountsUrlOption).toUtf8());
+        }
+
+        MainWindow window(nullptr, parser.value(scaleTestOption));
         app.mainWindow = &window;
+        startup.mark("mainWindow");
+        startup.watch(&window);
+
+        if (parser.isSet(scaleTestOption)) {
+            ScaleTest* scaleTest = new ScaleTest(&window, sinceStart,
+                                                 parser.value(scaleReportOption), &window);
+            scaleTest->start();
+        }
         window.show();
         
         // Handle macOS specific quit events
@@ -39,6 +91,9 @@ int main(int argc, char *argv[])
         });
         
         int result = app.exec();
+        if (!Trace::stop()) {
+            qWarning() << "Could not write trace file";
+        }
         curl_global_cleanup();
         return result;
     } catch (const std::exception& e) {
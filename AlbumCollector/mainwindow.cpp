@@ -1,4 +1,11 @@
 #include "mainwindow.h"
+#include "themestyle.h"
+#include "librarygrid.h"
+#include "thumbnailcache.h"
+#include "eventloopmonitor.h"
+#include "duplicatesdialog.h"
+#include "libraryimporter.h"
+#include "covertransfer.h"
 #include <QMessageBox>
 #include <QScrollArea>
 #include <QDialog>
@@ -15,12 +22,36 @@
 #include <QDir>
 #include <QComboBox>
 #include <QDate>
+#include <QDateTime>
 #include <QColorDialog>
 #include <QSettings>
 #include <QMenu>
 #include <QPainter>
+#include <QMouseEvent>
 #include <QApplication>
 #include <QScrollBar>
+#include <QtConcurrent>
+#include <QSignalBlocker>
+#include <QElapsedTimer>
+#include <QProgressBar>
+#include <QFormLayout>
+#include <QLocale>
+#include <QNetworkDiskCache>
+#include <QImageReader>
+#include <QFileDialog>
+#include <QProgressDialog>
+#include <QtMath>
+#include <QUndoStack>
+#include <QPointer>
+#include "AlbumStream.h"
+#include "CoverHash.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 AlbumListItem::AlbumListItem(const Album& album, QWidget* parent, bool showRating)
     : QWidget(parent), m_album(album)
@@ -30,7 +61,7 @@ AlbumListItem::AlbumListItem(const Album& album, QWidget* parent, bool showRatin
     
     // Image label
     imageLabel = new QLabel;
-    imageLabel->setFixedSize(60, 60);
+    imageLabel->setFixedSize(MainWindow::ThumbnailSize, MainWindow::ThumbnailSize);
     imageLabel->setScaledContents(true);
     topLayout->addWidget(imageLabel);
     
@@ -50,7 +81,12 @@ AlbumListItem::AlbumListItem(const Album& album, QWidget* parent, bool showRatin
     // Add to Library button
     addToLibraryButton = new QPushButton("Add to Library");
     addToLibraryButton->setFixedWidth(120);
-    addToLibraryButton->setStyleSheet("font-size: 11px;");
+    static const QFont buttonFont = [] {
+        QFont font;
+        font.setPixelSize(11);
+        return font;
+    }();
+    addToLibraryButton->setFont(buttonFont);
     topLayout->addWidget(addToLibraryButton);
     
     mainLayout->addLayout(topLayout);
@@ -95,16 +131,14 @@ void AlbumListItem::setAddToLibraryState(bool enabled, const QString& text)
     addToLibraryButton->setEnabled(enabled);
     addToLibraryButton->setText(text);
     
-    // Set a dynamic property based on the button state
+    // ThemeStyle draws "Added" buttons in the accent colour; a repaint is
+    // enough, no re-polish
     addToLibraryButton->setProperty("isAdded", text == "Added");
-    
-    // Trigger style update
-    addToLibraryButton->style()->unpolish(addToLibraryButton);
-    addToLibraryButton->style()->polish(addToLibraryButton);
     addToLibraryButton->update();
 }
 
 void AlbumListItem::setRating(int rating) {
+    m_album.rating = rating;
     if (ratingWidget) {
         ratingWidget->setRating(rating);
     }
@@ -114,152 +148,150 @@ int AlbumListItem::getRating() const {
     return ratingWidget ? ratingWidget->getRating() : 0;
 }
 
+// Every row shares the two record pixmaps, scaled once for the screen's
+// device pixel ratio
+const RatingWidget::RecordPixmaps& RatingWidget::recordPixmaps(qreal dpr) {
+    static RecordPixmaps pixmaps;
+    if (pixmaps.dpr != dpr) {
+        const int size = qRound(RecordSize * dpr);
+        QPixmap source(":/images/BlackWhiteRecord.png");
+        pixmaps.normal = source.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        pixmaps.normal.setDevicePixelRatio(dpr);
+
+        // Grayed out version
+        pixmaps.grayed = pixmaps.normal;
+        QPainter painter(&pixmaps.grayed);
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+        painter.fillRect(pixmaps.grayed.rect(), QColor(0, 0, 0, 128));
+        painter.end();
+        pixmaps.dpr = dpr;
+    }
+    return pixmaps;
+}
+
 RatingWidget::RatingWidget(QWidget* parent) : QWidget(parent), currentRating(0) {
-    // Load record images
-    normalRecord = QPixmap(":/images/BlackWhiteRecord.png");
-    grayedRecord = QPixmap(":/images/BlackWhiteRecord.png");
-    
-    // Create grayed out version
-    QPixmap temp = grayedRecord;
-    QPainter painter(&temp);
-    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    painter.fillRect(temp.rect(), QColor(0, 0, 0, 128));
-    grayedRecord = temp;
-
-    // Scale records to a reasonable size
-    normalRecord = normalRecord.scaled(20, 20, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    grayedRecord = grayedRecord.scaled(20, 20, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    
-    layout = new QHBoxLayout(this);
-    layout->setSpacing(0);  // Set initial spacing to 0
-    layout->setContentsMargins(0, 0, 0, 0);
-
-    // Create rating label
-    ratingLabel = new QLabel(this);
-    ratingLabel->setVisible(false);
-    layout->addWidget(ratingLabel);
-
-    // Create icon label with no margins
-    iconLabel = new QLabel(this);
-    iconLabel->setPixmap(normalRecord);
-    iconLabel->setContentsMargins(0, 0, 0, 0);
-    iconLabel->setVisible(false);
-    layout->addWidget(iconLabel);
-    
-    // Add stretch at the end to push everything to the left
-    layout->addStretch();
-    
-    setupRecords();
+    setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+    setCursor(Qt::PointingHandCursor);
     setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, &QWidget::customContextMenuRequested, this, [this](const QPoint&) {
         resetRating();
     });
 }
 
-void RatingWidget::setupRecords() {
-    for (int i = 0; i < MAX_RATING; ++i) {
-        QLabel* label = new QLabel;
-        label->setPixmap(grayedRecord);
-        label->setCursor(Qt::PointingHandCursor);
-        label->installEventFilter(this);
-        recordLabels.append(label);
-        layout->addWidget(label);
-    }
+QSize RatingWidget::sizeHint() const {
+    return QSize(MAX_RATING * RecordSize, RecordSize);
+}
+
+QSize RatingWidget::minimumSizeHint() const {
+    return sizeHint();
 }
 
+// Programmatic; only user clicks emit ratingChanged
 void RatingWidget::setRating(int value) {
-    currentRating = qBound(0, value, MAX_RATING);
+    const int rating = qBound(0, value, MAX_RATING);
+    if (rating == currentRating) return;
+    currentRating = rating;
     updateDisplay();
-    emit ratingChanged(currentRating);
 }
 
 void RatingWidget::resetRating() {
-    // First reset the rating to 0
     currentRating = 0;
-    
-    // Clear the rating text display
-    ratingLabel->setVisible(false);
-    
-    // Show the record labels for new rating
-    showRecords();
-    
-    // Emit the rating changed signal
+    updateDisplay();
     emit ratingChanged(currentRating);
 }
 
 void RatingWidget::updateDisplay() {
+    // Records are clickable only while no rating is set, as before
     if (currentRating > 0) {
-        showRatingText();
+        unsetCursor();
     } else {
-        showRecords();
+        setCursor(Qt::PointingHandCursor);
     }
+    update();
 }
 
-void RatingWidget::showRecords() {
-    // Hide rating label and icon
-    ratingLabel->setVisible(false);
-    iconLabel->setVisible(false);
-
-    // If we need to recreate the record labels
-    if (recordLabels.isEmpty()) {
-        setupRecords();
-    }
+void RatingWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    const RecordPixmaps& pixmaps = recordPixmaps(devicePixelRatioF());
+    const int top = (height() - RecordSize) / 2;
 
-    // Show all record labels and update their state
-    for (int i = 0; i < recordLabels.size(); ++i) {
-        recordLabels[i]->setVisible(true);
-        recordLabels[i]->setPixmap(i < currentRating ? normalRecord : grayedRecord);
+    if (currentRating == 0) {
+        for (int i = 0; i < MAX_RATING; ++i) {
+            painter.drawPixmap(i * RecordSize, top, pixmaps.grayed);
+        }
+        return;
     }
 
-    // Ensure layout is properly updated
-    layout->update();
+    // "7/10" followed by a single record
+    static const QStringList labels = [] {
+        QStringList texts;
+        for (int i = 0; i <= MAX_RATING; ++i) texts << QString("%1/%2").arg(i).arg(MAX_RATING);
+        return texts;
+    }();
+    const QString& text = labels[currentRating];
+    const int textWidth = fontMetrics().horizontalAdvance(text);
+    painter.setPen(palette().color(QPalette::WindowText));
+    painter.drawText(QRect(0, 0, textWidth, height()), Qt::AlignLeft | Qt::AlignVCenter, text);
+    painter.drawPixmap(textWidth + 2, top, pixmaps.normal);
 }
 
-void RatingWidget::showRatingText() {
-    // Hide record labels
-    for (QLabel* label : recordLabels) {
-        label->setVisible(false);
-        label->deleteLater();
+void RatingWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton || currentRating > 0) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    const int index = int(event->position().x()) / RecordSize;
+    if (index >= 0 && index < MAX_RATING) {
+        currentRating = index + 1;
+        updateDisplay();
+        emit ratingChanged(currentRating);
     }
-    recordLabels.clear();
-
-    // Show rating text with record icon
-    QString ratingText = QString("%1/10").arg(currentRating);
-    ratingLabel->setText(ratingText);
-    ratingLabel->setVisible(true);
-
-    // Adjust icon label spacing and position
-    iconLabel->setContentsMargins(0, 0, 0, 0);  // Remove all margins
-    iconLabel->setVisible(true);
-    
-    // Create a tighter layout
-    layout->setSpacing(0);  // Remove spacing between widgets
-    
-    // Add a small fixed width spacer (2-3 pixels) between text and icon
-    QSpacerItem* spacer = new QSpacerItem(2, 0, QSizePolicy::Fixed, QSizePolicy::Minimum);
-    layout->addSpacerItem(spacer);
-
-    // Ensure layout is properly updated
-    layout->update();
 }
 
-bool RatingWidget::eventFilter(QObject* obj, QEvent* event) {
-    if (event->type() == QEvent::MouseButtonPress) {
-        QLabel* clickedLabel = qobject_cast<QLabel*>(obj);
-        if (clickedLabel) {
-            int newRating = recordLabels.indexOf(clickedLabel) + 1;
-            setRating(newRating);
-            return true;
+// One library change on the undo stack. It keeps only the mutation that
+// reverses its last application, and applying that hands back the one that
+// reverses it in turn. Albums put back go where they were, unless the
+// library has been sorted since, in which case it is sorted again.
+class LibraryCommand : public QUndoCommand {
+public:
+    LibraryCommand(MainWindow* window, const QString& text, LibraryMutation inverse)
+        : QUndoCommand(text), window(window), reverse(std::move(inverse)), order(window->libraryOrder) {}
+
+    void undo() override { flip(); }
+    void redo() override {
+        // The change was made before the command was pushed
+        if (pushed) {
+            pushed = false;
+            return;
         }
+        flip();
     }
-    return QWidget::eventFilter(obj, event);
-}
 
-MainWindow::MainWindow(QWidget *parent)
+private:
+    MainWindow* window;
+    LibraryMutation reverse;
+    int order;
+    bool pushed = true;
+
+    void flip() {
+        reverse = window->applyLibraryMutation(reverse, window->libraryOrder != order);
+        order = window->libraryOrder;
+    }
+};
+
+MainWindow::MainWindow(QWidget *parent, const QString& libraryPath)
     : QMainWindow(parent)
     , spotify("9c18388b794041aca87c4f3d975e580e", "f0228bebde384425865f5a6bc93dd979")
+    , searchCache(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/search_cache.dat")
+    , libraryStore(libraryPath.isEmpty() ? LibraryStore::defaultPath() : libraryPath)
+    , thumbnailSidecar(ThumbnailSidecar::pathFor(libraryStore.path()))
 {
     networkManager = new QNetworkAccessManager(this);
+    QNetworkDiskCache* coverCache = new QNetworkDiskCache(networkManager);
+    coverCache->setCacheDirectory(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/covers");
+    coverCache->setMaximumCacheSize(64 * 1024 * 1024);
+    networkManager->setCache(coverCache);
     connect(networkManager, &QNetworkAccessManager::finished,
             this, &MainWindow::handleImageDownloaded);
 
@@ -271,8 +303,66 @@ MainWindow::MainWindow(QWidget *parent)
         performSearch(false);
     });
 
+    // While offline, keep retrying the live pages of the current search
+    reconnectTimer = new QTimer(this);
+    reconnectTimer->setSingleShot(true);
+    reconnectTimer->setInterval(15000);
+    connect(reconnectTimer, &QTimer::timeout, this, &MainWindow::retryOfflineSearches);
+
+    searchCache.load();
+
+    librarySaveTimer = new QTimer(this);
+    librarySaveTimer->setSingleShot(true);
+    librarySaveTimer->setInterval(LibrarySaveDelayMs);
+    connect(librarySaveTimer, &QTimer::timeout, this, &MainWindow::saveLibrary);
+
+    enrichmentWatcher = new QFutureWatcher<void>(this);
+    connect(enrichmentWatcher, &QFutureWatcher<void>::finished, this, [this]() {
+        if (enrichmentPending) {
+            enrichmentPending = false;
+            enrichLibrary();
+        }
+    });
+
+    // Rows only turn sidecar images into pixmaps, which copies them, so
+    // swapping in the new mapping leaves nothing pointing at the old one
+    sidecarWatcher = new QFutureWatcher<bool>(this);
+    connect(sidecarWatcher, &QFutureWatcher<bool>::finished, this, [this]() {
+        if (sidecarWatcher->result()) thumbnailSidecar.open(sidecarWatcher->property("pixels").toInt());
+    });
+
+    colorWatcher = new QFutureWatcher<ColorSignature>(this);
+    connect(colorWatcher, &QFutureWatcher<ColorSignature>::finished, this, [this]() {
+        const QList<ColorSignature> signatures = colorWatcher->future().results();
+        QHash<QString, ColorSignature> byId;
+        for (int i = 0; i < colorPending.size() && i < signatures.size(); ++i) {
+            if (signatures[i].valid) byId.insert(colorPending[i], signatures[i]);
+            else colorlessCovers.insert(colorPending[i]);
+        }
+        colorPending.clear();
+        for (auto& libAlbum : libraryAlbums) {
+            auto it = byId.constFind(QString::fromStdString(libAlbum.album.id));
+            if (it != byId.constEnd()) libAlbum.colors = *it;
+        }
+        scheduleLibrarySave();
+        updateCoverTheme();
+        // Albums added while this ran
+        computeColorSignatures();
+    });
+
+    // Library changes undo from anywhere in the window; text fields keep
+    // their own undo while they have focus
+    undoStack = new QUndoStack(this);
+    undoStack->setUndoLimit(UndoLimit);
+    undoAction = undoStack->createUndoAction(this, "Undo");
+    undoAction->setShortcuts(QKeySequence::Undo);
+    redoAction = undoStack->createRedoAction(this, "Redo");
+    redoAction->setShortcuts(QKeySequence::Redo);
+    addActions({undoAction, redoAction});
+
     setupUi();
     loadLibrary();
+    enrichLibrary();
 }
 
 void MainWindow::setupUi()
@@ -294,31 +384,34 @@ void MainWindow::setupUi()
     stackedWidget = new QStackedWidget;
     mainLayout->addWidget(stackedWidget);
 
-    // Setup pages
+    // Only the search page is needed for the first frame; the library and
+    // settings pages are built on first visit
     setupSearchPage();
-    setupLibraryPage();
-    setupSettingsPage();
-
     stackedWidget->addWidget(searchPage);
-    stackedWidget->addWidget(libraryPage);
-    stackedWidget->addWidget(settingsPage);
 
     // Set stretch factors
     mainLayout->setStretchFactor(sidebar, 0);
     mainLayout->setStretchFactor(stackedWidget, 1);
 
-    // Add right-click menu to library list
-    libraryList->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(libraryList, &QListWidget::customContextMenuRequested, 
-            this, [this](const QPoint& pos) {
-        QMenu contextMenu(tr("Context menu"), this);
-        QAction* removeAction = contextMenu.addAction("Remove Album");
-        
-        connect(removeAction, &QAction::triggered, 
-                this, &MainWindow::removeSelectedAlbum);
-        
-        contextMenu.exec(libraryList->mapToGlobal(pos));
-    });
+    loadThemes();
+    applySavedTheme();
+}
+
+void MainWindow::ensureLibraryPage()
+{
+    if (libraryPage) return;
+    TRACE_SPAN("setupLibraryPage", "ui");
+    setupLibraryPage();
+    stackedWidget->addWidget(libraryPage);
+    refreshLibraryDisplay();
+}
+
+void MainWindow::ensureSettingsPage()
+{
+    if (settingsPage) return;
+    TRACE_SPAN("setupSettingsPage", "ui");
+    setupSettingsPage();
+    stackedWidget->addWidget(settingsPage);
 }
 
 void MainWindow::setupSidebar()
@@ -356,6 +449,19 @@ void MainWindow::setupSidebar()
     bottomList->addItem(settingsItem);
     bottomList->setObjectName("bottomList"); // For finding it later
 
+    // Navigation entries are drawn by SidebarItemDelegate in the sidebar
+    // palette that applyTheme sets on the container
+    sidebarContainer->setAutoFillBackground(true);
+    QFont navigationFont;
+    navigationFont.setPixelSize(16);
+    navigationFont.setBold(true);
+    for (QListWidget* list : {sidebar, bottomList}) {
+        list->setFont(navigationFont);
+        list->setItemDelegate(new SidebarItemDelegate(list));
+        list->setMouseTracking(true);
+        list->viewport()->setAttribute(Qt::WA_Hover);
+    }
+
     // Add main navigation to layout
     sidebarLayout->addWidget(sidebar);
     sidebarLayout->addStretch();
@@ -378,12 +484,7 @@ void MainWindow::setupSidebar()
             QString text = current->text();
             if (text == "Search") switchToSearch();
             else if (text == "Library") switchToLibrary();
-            else if (text == "Settings") {
-                switchToSettings();
-                if (stackedWidget && settingsPage) {
-                    stackedWidget->setCurrentWidget(settingsPage);
-                }
-            }
+            else if (text == "Settings") switchToSettings();
         });
     };
 
@@ -478,6 +579,127 @@ void MainWindow::setupSearchPage()
     loadMoreButton->setVisible(false);
 }
 
+void MainWindow::importAlbums()
+{
+    if (importer && importer->isRunning()) {
+        importProgress->show();
+        return;
+    }
+    const QString path = QFileDialog::getOpenFileName(this, "Import Albums", QString(),
+                                                      "Album lists (*.csv *.json *.txt);;All files (*)");
+    if (path.isEmpty()) return;
+
+    if (!importer) {
+        importer = new LibraryImporter(spotify, imageTransferStats, this);
+        importProgress = new QProgressDialog(this);
+        importProgress->setWindowTitle("Import Albums");
+        importProgress->setMinimumDuration(0);
+        importProgress->setAutoClose(false);
+        importProgress->setAutoReset(false);
+        connect(importProgress, &QProgressDialog::canceled, importer, &LibraryImporter::cancel);
+        connect(importer, &LibraryImporter::progress, this, [this](int done, int total, const QString& stage) {
+            importProgress->setLabelText(stage);
+            importProgress->setMaximum(qMax(1, total));
+            importProgress->setValue(qMin(done, total));
+        });
+        connect(importer, &LibraryImporter::finished, this, &MainWindow::commitImport);
+    }
+
+    QString error;
+    importProgress->reset();
+    importProgress->show();
+    if (!importer->start(path, libraryAlbumIds, &error)) {
+        importProgress->hide();
+        QMessageBox::warning(this, "Import Albums", "Could not import " + path + ":\n" + error);
+    }
+}
+
+// Everything an import found goes in as one change, and comes out again
+// as one undo step: the index and facets take each album, then the
+// library is sorted, shown and saved once. The downloaded covers are
+// stored as they came, with no PNG round trip.
+void MainWindow::commitImport(const QVector<LibraryAlbum>& albums, int unresolved, int failed, bool cancelled)
+{
+    TRACE_SPAN("commitImport", "storage");
+    importProgress->hide();
+    if (cancelled) return;  // The journal lets the same file pick up from here
+
+    LibraryMutation mutation;
+    for (const LibraryAlbum& libAlbum : albums) mutation.add(libAlbum);
+    changeLibrary(QString("Import %1 Albums").arg(albums.size()), mutation, true);
+    importer->commit();
+
+    QString summary = QString("Imported %1 albums").arg(albums.size());
+    if (unresolved > 0) summary += QString(", %1 not found").arg(unresolved);
+    summary += ".";
+    if (failed > 0) {
+        summary += QString("\n%1 could not be looked up; import the same file again to retry them.").arg(failed);
+    }
+    QMessageBox::information(this, "Import Albums", summary);
+}
+
+// Hashes every cover not hashed before on the thread pool, then groups
+// them. Hashes are kept for the session, so a second check is instant.
+void MainWindow::findDuplicates()
+{
+    if (coverHashWatcher->isRunning()) return;
+    duplicateScanTimer.start();
+
+    QVector<QByteArray> covers;
+    coverHashPending.clear();
+    for (const auto& libAlbum : libraryAlbums) {
+        const QString id = QString::fromStdString(libAlbum.album.id);
+        auto cached = coverHashes.constFind(id);
+        if (cached != coverHashes.constEnd() && cached->first == libAlbum.imageData.size()) continue;
+        coverHashPending.append({id, libAlbum.imageData.size()});
+        covers.append(libAlbum.imageData);
+    }
+    if (covers.isEmpty()) {
+        showDuplicates();
+        return;
+    }
+
+    duplicatesButton->setEnabled(false);
+    duplicatesButton->setText("Checking covers...");
+    coverHashWatcher->setFuture(QtConcurrent::mapped(covers, &DuplicatesDialog::hashCover));
+}
+
+void MainWindow::showDuplicates()
+{
+    TRACE_SPAN("showDuplicates", "ui");
+    static Histogram& scanTime = Metrics::histogram("duplicates.scanUs");
+    duplicatesButton->setEnabled(true);
+    duplicatesButton->setText("Find Duplicates");
+
+    // Flat covers hash to 0 and would all match each other, so leave them out
+    DuplicateIndex index;
+    QVector<int> albumOf;
+    index.reserve(libraryAlbums.size());
+    for (int i = 0; i < libraryAlbums.size(); ++i) {
+        auto cached = coverHashes.constFind(QString::fromStdString(libraryAlbums[i].album.id));
+        if (cached == coverHashes.constEnd() || cached->second == 0) continue;
+        index.add(cached->second);
+        albumOf.append(i);
+    }
+
+    std::vector<std::vector<int>> groups = index.clusters(DuplicatesDialog::MatchDistance);
+    for (auto& group : groups) {
+        for (int& entry : group) entry = albumOf[entry];
+    }
+    scanTime.record(duplicateScanTimer.nsecsElapsed() / 1000);
+
+    QString summary = groups.empty()
+        ? QString("No look-alike covers among %1 albums.").arg(index.size())
+        : QString("%1 groups of albums with look-alike covers among %2 albums. "
+                  "Double-click an album for its details.").arg(groups.size()).arg(index.size());
+    DuplicatesDialog dialog(libraryAlbums, groups, summary, this);
+    connect(&dialog, &DuplicatesDialog::albumActivated, this, [this](const QString& albumId) {
+        const int row = libraryRowOf(albumId.toStdString());
+        if (row >= 0) showAlbumDialog(libraryAlbums[row].album);
+    });
+    dialog.exec();
+}
+
 void MainWindow::checkScrollPosition()
 {
     if (!resultsList || !loadMoreButton) return;
@@ -512,22 +734,109 @@ void MainWindow::setupLibraryPage()
     sortComboBox = new QComboBox;
     sortComboBox->setObjectName("sortComboBox");
     sortComboBox->setFixedWidth(150);  // Increased width to fit "Album Name"
-    sortComboBox->setStyleSheet("QComboBox { padding: 2px 5px; }");  // Add some padding
     
     // Add items with consistent formatting
     sortComboBox->addItem("Artist");
     sortComboBox->addItem("Album Name");
     sortComboBox->addItem("Release Date");
     sortComboBox->addItem("Rating ↓");
+    sortComboBox->addItem("Colour…");
     
     // Ensure the popup list is wide enough
     sortComboBox->setSizeAdjustPolicy(QComboBox::AdjustToContents);
     
+    // As-you-type filter backed by the library index
+    libraryFilterBox = new QLineEdit;
+    libraryFilterBox->setObjectName("libraryFilterBox");
+    libraryFilterBox->setPlaceholderText("Filter by album or artist...");
+    libraryFilterBox->setClearButtonEnabled(true);
+    libraryFilterBox->setMinimumWidth(200);
+
+    libraryCountLabel = new QLabel;
+    libraryCountLabel->setObjectName("libraryCountLabel");
+
     toolbarLayout->addWidget(sortLabel);
     toolbarLayout->addWidget(sortComboBox);
-    toolbarLayout->addStretch();
+    toolbarLayout->addSpacing(10);
+
+    // List rows carry ratings; the grid is a virtualized cover wall
+    viewModeBox = new QComboBox;
+    viewModeBox->setObjectName("viewModeBox");
+    viewModeBox->addItem("List");
+    viewModeBox->addItem("Grid");
+    toolbarLayout->addWidget(viewModeBox);
+    toolbarLayout->addSpacing(10);
+    toolbarLayout->addWidget(libraryFilterBox, 1);
+    toolbarLayout->addWidget(libraryCountLabel);
+
+    // Mirror the window's undo and redo actions; the tooltip names the step
+    auto addHistoryButton = [toolbarLayout](QAction* action, const QString& text, const QString& name) {
+        QPushButton* button = new QPushButton(text);
+        button->setObjectName(name);
+        button->setEnabled(action->isEnabled());
+        button->setToolTip(action->text());
+        QObject::connect(button, &QPushButton::clicked, action, &QAction::trigger);
+        QObject::connect(action, &QAction::changed, button, [button, action]() {
+            button->setEnabled(action->isEnabled());
+            button->setToolTip(action->text());
+        });
+        toolbarLayout->addWidget(button);
+    };
+    addHistoryButton(undoAction, "Undo", "undoButton");
+    addHistoryButton(redoAction, "Redo", "redoButton");
+
+    duplicatesButton = new QPushButton("Find Duplicates");
+    duplicatesButton->setObjectName("duplicatesButton");
+    connect(duplicatesButton, &QPushButton::clicked, this, &MainWindow::findDuplicates);
+    toolbarLayout->addWidget(duplicatesButton);
+
+    QPushButton* importButton = new QPushButton("Import…");
+    importButton->setObjectName("importButton");
+    importButton->setToolTip("Add albums from a CSV or JSON list of Spotify ids or artist/album pairs");
+    connect(importButton, &QPushButton::clicked, this, &MainWindow::importAlbums);
+    toolbarLayout->addWidget(importButton);
+
+    // Shown while rows are still being built
+    libraryProgress = new QProgressBar;
+    libraryProgress->setObjectName("libraryProgress");
+    libraryProgress->setFixedWidth(120);
+    libraryProgress->setTextVisible(false);
+    libraryProgress->hide();
+    toolbarLayout->addWidget(libraryProgress);
     
     layout->addWidget(toolbarWidget);
+
+    // Facet filters; each entry shows how many albums it would leave
+    QWidget* facetPanel = new QWidget;
+    facetPanel->setObjectName("facetPanel");
+    QHBoxLayout* facetLayout = new QHBoxLayout(facetPanel);
+    facetLayout->setContentsMargins(10, 0, 10, 5);
+
+    ratingFacetBox = new QComboBox;
+    ratingFacetBox->setObjectName("ratingFacetBox");
+    decadeFacetBox = new QComboBox;
+    decadeFacetBox->setObjectName("decadeFacetBox");
+    artistFacetBox = new QComboBox;
+    artistFacetBox->setObjectName("artistFacetBox");
+    artistFacetBox->setMinimumWidth(200);
+
+    for (QComboBox* box : {ratingFacetBox, decadeFacetBox, artistFacetBox}) {
+        box->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+        connect(box, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                this, &MainWindow::applyLibraryFilter);
+    }
+
+    facetLayout->addWidget(new QLabel("Rating:"));
+    facetLayout->addWidget(ratingFacetBox);
+    facetLayout->addSpacing(10);
+    facetLayout->addWidget(new QLabel("Decade:"));
+    facetLayout->addWidget(decadeFacetBox);
+    facetLayout->addSpacing(10);
+    facetLayout->addWidget(new QLabel("Artist:"));
+    facetLayout->addWidget(artistFacetBox);
+    facetLayout->addStretch();
+
+    layout->addWidget(facetPanel);
     
     // Create and setup library list
     libraryList = new QListWidget;
@@ -539,49 +848,86 @@ void MainWindow::setupLibraryPage()
     libraryList->setResizeMode(QListView::Adjust);
     libraryList->setWordWrap(true);
     
-    layout->addWidget(libraryList);
+    thumbnailCache = new ThumbnailCache(this);
+    libraryGridModel = new LibraryGridModel(&libraryAlbums, this);
+    libraryGrid = new LibraryGridView(thumbnailCache);
+    libraryGrid->setObjectName("libraryGrid");
+    libraryGrid->setFrameShape(QFrame::NoFrame);
+    libraryGrid->setModel(libraryGridModel);
+    connect(libraryGrid, &LibraryGridView::albumActivated, this, [this](int albumIndex) {
+        showAlbumDialog(libraryAlbums[albumIndex].album);
+    });
+
+    libraryViews = new QStackedWidget;
+    libraryViews->addWidget(libraryList);
+    libraryViews->addWidget(libraryGrid);
+    layout->addWidget(libraryViews);
+
+    viewModeBox->setCurrentIndex(QSettings("YourCompany", "AlbumCollector").value("libraryView", 0).toInt());
+    libraryViews->setCurrentIndex(viewModeBox->currentIndex());
+    connect(viewModeBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int mode) {
+        QSettings("YourCompany", "AlbumCollector").setValue("libraryView", mode);
+        libraryViews->setCurrentIndex(mode);
+        refreshLibraryDisplay();
+    });
     
     // Connect signals
     connect(libraryList, &QListWidget::itemDoubleClicked, 
             this, &MainWindow::showAlbumDetails);
     connect(sortComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::sortLibrary);
+    // Choosing Colour… again picks a new colour
+    connect(sortComboBox, QOverload<int>::of(&QComboBox::activated), this, [this](int index) {
+        if (index == SortByColor) pickBrowseColor();
+    });
+    connect(libraryFilterBox, &QLineEdit::textChanged,
+            this, &MainWindow::applyLibraryFilter);
     
     // Set default sort to Artist
     sortComboBox->setCurrentIndex(0);
-}
 
-void MainWindow::setupSettingsPage()
-{
-    settingsPage = new QWidget;
-    QVBoxLayout* layout = new QVBoxLayout(settingsPage);
-    layout->setContentsMargins(20, 20, 20, 20);
-    layout->setSpacing(20);
+    // Both views select any number of albums; the menu acts on all of them
+    libraryList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    libraryList->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(libraryList, &QListWidget::customContextMenuRequested, this, [this](const QPoint& pos) {
+        QListWidgetItem* item = libraryList->itemAt(pos);
+        showLibraryContextMenu(libraryList->mapToGlobal(pos), item ? libraryList->row(item) : -1);
+    });
 
-    // Header
-    QLabel* header = new QLabel("Settings");
-    header->setStyleSheet("font-size: 24px; font-weight: bold;");
-    layout->addWidget(header);
+    libraryGrid->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(libraryGrid, &QWidget::customContextMenuRequested, this, [this](const QPoint& pos) {
+        const QModelIndex index = libraryGrid->indexAt(pos);
+        showLibraryContextMenu(libraryGrid->viewport()->mapToGlobal(pos),
+                               index.isValid() ? index.data(LibraryGridModel::AlbumIndexRole).toInt() : -1);
+    });
 
-    // Theme section
-    QLabel* themeHeader = new QLabel("Theme");
-    themeHeader->setStyleSheet("font-size: 18px; font-weight: bold;");
-    layout->addWidget(themeHeader);
+    QAction* deleteAction = new QAction(libraryViews);
+    deleteAction->setShortcuts(QKeySequence::Delete);
+    deleteAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    libraryViews->addAction(deleteAction);
+    connect(deleteAction, &QAction::triggered, this, [this]() {
+        removeLibraryAlbums(selectedLibraryAlbumIds());
+    });
 
-    // Create theme list with adjusted dimensions
-    themeList = new QListWidget;
-    themeList->setObjectName("themeList");
-    themeList->setViewMode(QListWidget::IconMode);
-    themeList->setIconSize(QSize(120, 80));      // Keep preview size
-    themeList->setSpacing(15);                   // Slightly increase spacing
-    themeList->setResizeMode(QListWidget::Adjust);
-    themeList->setMovement(QListWidget::Static);
-    themeList->setWrapping(true);
-    themeList->setUniformItemSizes(true);
-    themeList->setGridSize(QSize(150, 110));     // Increase grid size to fit text
-    themeList->setMinimumHeight(400);            // Increase minimum height to show more items
+    // Rows are built a time slice per event-loop turn, see populateLibraryChunk
+    libraryPopulateTimer = new QTimer(this);
+    libraryPopulateTimer->setInterval(0);
+    connect(libraryPopulateTimer, &QTimer::timeout, this, &MainWindow::populateLibraryChunk);
+    populateMonitor = new EventLoopMonitor(this);
+
+    coverHashWatcher = new QFutureWatcher<quint64>(this);
+    connect(coverHashWatcher, &QFutureWatcher<quint64>::finished, this, [this]() {
+        const QList<quint64> hashes = coverHashWatcher->future().results();
+        for (int i = 0; i < coverHashPending.size() && i < hashes.size(); ++i) {
+            coverHashes.insert(coverHashPending[i].first, {coverHashPending[i].second, hashes[i]});
+        }
+        coverHashPending.clear();
+        showDuplicates();
+    });
+}
 
-    // Update themes with more variety
+void MainWindow::loadThemes()
+{
     themes = {
         ThemeColors("Glacier Blue", 
             QColor("#EEF5FF"), // background
@@ -681,32 +1027,90 @@ void MainWindow::setupSettingsPage()
         )
     };
 
+    // Recoloured by updateCoverTheme once the library's covers are known
+    coverThemeIndex = themes.size();
+    themes.append(themeFromSeed("From Your Covers", QColor("#5B7DB1")));
+}
+
+int MainWindow::savedThemeIndex() const
+{
+    QSettings settings("YourCompany", "AlbumCollector");
+    int index = settings.value("themeIndex", 0).toInt();
+    return index >= 0 && index < themes.size() ? index : 0;
+}
+
+// Styling only; the settings page with its theme previews is built on
+// first visit
+void MainWindow::applySavedTheme()
+{
+    applyTheme(themes[savedThemeIndex()]);
+}
+
+QPixmap MainWindow::themePreview(const ThemeColors& theme)
+{
+    QPixmap preview(120, 80);
+    QPainter painter(&preview);
+    
+    // Draw background
+    painter.fillRect(0, 0, 120, 80, theme.background);
+    
+    // Draw sidebar representation
+    painter.fillRect(0, 0, 20, 80, theme.sidebar);
+    
+    // Draw accent color sample
+    painter.fillRect(95, 5, 20, 20, theme.accent);
+    return preview;
+}
+
+static QFont headingFont(int pixelSize)
+{
+    QFont font;
+    font.setPixelSize(pixelSize);
+    font.setBold(true);
+    return font;
+}
+
+void MainWindow::setupSettingsPage()
+{
+    settingsPage = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(settingsPage);
+    layout->setContentsMargins(20, 20, 20, 20);
+    layout->setSpacing(20);
+
+    // Header
+    QLabel* header = new QLabel("Settings");
+    header->setFont(headingFont(24));
+    layout->addWidget(header);
+
+    // Theme section
+    QLabel* themeHeader = new QLabel("Theme");
+    themeHeader->setFont(headingFont(18));
+    layout->addWidget(themeHeader);
+
+    // Create theme list with adjusted dimensions
+    themeList = new QListWidget;
+    themeList->setObjectName("themeList");
+    themeList->setViewMode(QListWidget::IconMode);
+    themeList->setIconSize(QSize(120, 80));      // Keep preview size
+    themeList->setSpacing(15);                   // Slightly increase spacing
+    themeList->setResizeMode(QListWidget::Adjust);
+    themeList->setMovement(QListWidget::Static);
+    themeList->setWrapping(true);
+    themeList->setUniformItemSizes(true);
+    themeList->setGridSize(QSize(150, 110));     // Increase grid size to fit text
+    themeList->setMinimumHeight(400);            // Increase minimum height to show more items
+
     // Add theme previews with better text visibility
     for (const auto& theme : themes) {
-        QPixmap preview(120, 80);
-        QPainter painter(&preview);
-        
-        // Draw background
-        painter.fillRect(0, 0, 120, 80, theme.background);
-        
-        // Draw sidebar representation
-        painter.fillRect(0, 0, 20, 80, theme.sidebar);
-        
-        // Draw accent color sample
-        painter.fillRect(95, 5, 20, 20, theme.accent);
-        
         QListWidgetItem* item = new QListWidgetItem(theme.name);
-        item->setIcon(QIcon(preview));
+        item->setIcon(QIcon(themePreview(theme)));
         themeList->addItem(item);
     }
 
     layout->addWidget(themeList);
     
-    // Load and apply saved theme
-    QSettings settings("YourCompany", "AlbumCollector");
-    int savedThemeIndex = settings.value("themeIndex", 0).toInt();
-    themeList->setCurrentRow(savedThemeIndex);
-    applyTheme(themes[savedThemeIndex]);
+    // The saved theme is already applied; just show it as selected
+    themeList->setCurrentRow(savedThemeIndex());
 
     // Connect theme selection
     connect(themeList, &QListWidget::currentRowChanged, this, [this](int row) {
@@ -717,231 +1121,97 @@ void MainWindow::setupSettingsPage()
         }
     });
 
+    // Diagnostics section, refreshed once a second while the page is shown
+    QLabel* diagnosticsHeader = new QLabel("Diagnostics");
+    diagnosticsHeader->setFont(headingFont(18));
+    layout->addWidget(diagnosticsHeader);
+
+    QFormLayout* diagnosticsLayout = new QFormLayout;
+    const QStringList diagnostics = {
+        "Search latency", "Image cache hit rate", "Downloaded", "Library saves",
+        "Library load time", "Library row build", "Startup", "Live widgets", "Resident memory"
+    };
+    for (const QString& name : diagnostics) {
+        QLabel* value = new QLabel("-");
+        value->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        diagnosticsLayout->addRow(name + ":", value);
+        diagnosticsLabels.insert(name, value);
+    }
+    layout->addLayout(diagnosticsLayout);
+
+    diagnosticsTimer = new QTimer(this);
+    diagnosticsTimer->setInterval(1000);
+    connect(diagnosticsTimer, &QTimer::timeout, this, &MainWindow::updateDiagnostics);
+
     layout->addStretch();
 }
 
-void MainWindow::applyTheme(const ThemeColors& theme)
+void MainWindow::updateDiagnostics()
 {
-    // Main window style
-    QString mainStyle = QString(
-        "QMainWindow, QWidget#centralWidget {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "}"
-        "QPushButton {"
-        "    background-color: %3;"
-        "    color: %2;"
-        "    border: none;"
-        "    padding: 5px 15px;"
-        "    border-radius: 4px;"
-        "    font-size: 12px;"
-        "}"
-        "QPushButton:hover {"
-        "    background-color: %4;"
-        "    color: white;"
-        "}"
-        "QPushButton:disabled {"
-        "    background-color: #CCCCCC;"
-        "    color: #666666;"
-        "}"
-        "QLineEdit {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    border: 1px solid %4;"
-        "    padding: 5px;"
-        "    border-radius: 4px;"
-        "}"
-        "QListWidget {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    border: none;"
-        "}"
-        "QLabel {"
-        "    color: %2;"
-        "}"
-        "QComboBox {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    border: 1px solid %4;"
-        "    padding: 5px;"
-        "    border-radius: 4px;"
-        "}"
-        "QComboBox::drop-down {"
-        "    border: none;"
-        "}"
-        "QComboBox::down-arrow {"
-        "    image: none;"
-        "    border-left: 5px solid %2;"
-        "    border-right: 5px solid transparent;"
-        "    border-top: 5px solid %2;"
-        "    width: 0;"
-        "    height: 0;"
-        "    margin-right: 5px;"
-        "}"
-        "QComboBox QAbstractItemView {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    selection-background-color: %4;"
-        "    selection-color: white;"
-        "}"
-        "QWidget#toolbarWidget {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    border-bottom: 1px solid %4;"
-        "}"
-        "QWidget#toolbarWidget QLabel {"
-        "    color: %2;"
-        "}"
-        "QComboBox#sortComboBox {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    border: 1px solid %4;"
-        "    padding: 5px;"
-        "    border-radius: 4px;"
-        "    min-height: 20px;"
-        "}"
-        "QComboBox#sortComboBox::drop-down {"
-        "    border: none;"
-        "    width: 20px;"
-        "}"
-        "QComboBox#sortComboBox::down-arrow {"
-        "    image: none;"
-        "    border-left: 5px solid %2;"
-        "    border-right: 5px solid transparent;"
-        "    border-top: 5px solid %2;"
-        "    width: 0;"
-        "    height: 0;"
-        "    margin-right: 5px;"
-        "}"
-        "QComboBox#sortComboBox QAbstractItemView {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "    border: 1px solid %4;"
-        "    selection-background-color: %4;"
-        "    selection-color: white;"
-        "}"
-        "QComboBox#sortComboBox:hover {"
-        "    border-color: %4;"
-        "}"
-        "QComboBox#sortComboBox:focus {"
-        "    border-color: %4;"
-        "    border-width: 2px;"
-        "}"
-        "QListWidget::item:selected {"
-        "    background-color: %4;"
-        "    color: white;"
-        "}"
-        "QListWidget::item:hover:!selected {"
-        "    background-color: %1;"
-        "    border: 1px solid %4;"
-        "}"
-        "QListWidget#resultsList::item:selected, QListWidget#libraryList::item:selected {"
-        "    background-color: %4;"
-        "}"
-        "QListWidget#resultsList::item:hover:!selected, QListWidget#libraryList::item:hover:!selected {"
-        "    background-color: %1;"
-        "    border: 1px solid %4;"
-        "}"
-        "QListWidget#themeList {"
-        "    background-color: %1;"
-        "    color: %2;"
-        "}"
-        "QListWidget#themeList::item {"
-        "    color: %2;"
-        "    background-color: transparent;"
-        "}"
-        "QListWidget#themeList::item:selected {"
-        "    background-color: %4;"
-        "    color: white;"
-        "}"
-        "QPushButton[isAdded=\"true\"] {"
-        "    font-size: 11px;"
-        "    background-color: %4;"
-        "    color: white;"
-        "}"
-        "QPushButton[isAdded=\"false\"] {"
-        "    font-size: 11px;"
-        "    background-color: %3;"
-        "    color: %2;"
-        "}"
-        "QWidget {"
-        "    selection-background-color: %4;"
-        "    selection-color: white;"
-        "}"
-        "QLineEdit {"
-        "    selection-background-color: %4;"
-        "    selection-color: white;"
-        "}"
-        "QLabel {"
-        "    selection-background-color: %4;"
-        "    selection-color: white;"
-        "}"
-        "QListWidget {"
-        "    selection-background-color: %4;"
-        "    selection-color: white;"
-        "}"
-    ).arg(theme.background.name(),
-          theme.text.name(),
-          theme.sidebar.name(),
-          theme.accent.name());
-
-    // Sidebar specific style
-    QString sidebarStyle = QString(
-        "QListWidget {"
-        "    background-color: %1;"
-        "    border: none;"
-        "    color: %2;"
-        "}"
-        "QListWidget::item {"
-        "    padding: 12px 15px;"
-        "    border: none;"
-        "    color: %2;"
-        "    font-size: 16px;"     // Increased from 14px to 16px
-        "    font-weight: bold;"    // Added bold
-        "    border-bottom: 1px solid %4;"
-        "}"
-        "QListWidget::item:selected {"
-        "    background-color: %3;"
-        "    color: white;"
-        "    border-bottom: 1px solid %3;"
-        "}"
-        "QListWidget::item:hover:!selected {"
-        "    background-color: %4;"
-        "    color: white;"
-        "}"
-    ).arg(theme.sidebar.name(),
-          theme.text.name(),
-          theme.accent.name(),
-          theme.sidebar.darker(120).name());
-
-    // Apply styles
-    this->setStyleSheet(mainStyle);
-    
-    // Apply sidebar style to both lists
-    sidebar->setStyleSheet(sidebarStyle);
-    if (QListWidget* bottomList = sidebar->parentWidget()->findChild<QListWidget*>("bottomList")) {
-        bottomList->setStyleSheet(sidebarStyle);
+    if (stackedWidget->currentWidget() != settingsPage) {
+        diagnosticsTimer->stop();
+        return;
     }
 
-    // Apply container style to ensure full height coloring
-    sidebar->parentWidget()->setStyleSheet(QString(
-        "background-color: %1;"
-    ).arg(theme.sidebar.name()));
-
-    // Ensure the settings page is properly initialized
-    if (!settingsPage) {
-        setupSettingsPage();
-    }
+    static const Histogram& searchLatency = Metrics::histogram("search.latencyUs");
+    static const Counter& cacheHits = Metrics::counter("images.cacheHits");
+    static const Counter& cacheMisses = Metrics::counter("images.cacheMisses");
+    static const Counter& wireBytes = Metrics::counter("network.wireBytes");
+    static const Counter& saves = Metrics::counter("library.saves");
+    static const Histogram& saveTime = Metrics::histogram("library.saveUs");
+    static const Gauge& loadTime = Metrics::gauge("library.loadMs");
+
+    auto ms = [](uint64_t us) { return QString::number(us / 1000.0, 'f', 1) + " ms"; };
+    QLocale locale;
+
+    diagnosticsLabels["Search latency"]->setText(searchLatency.count() == 0 ? "-" :
+        QString("p50 %1, p95 %2, p99 %3 (%4 searches)")
+            .arg(ms(searchLatency.percentile(0.50)), ms(searchLatency.percentile(0.95)),
+                 ms(searchLatency.percentile(0.99)))
+            .arg(searchLatency.count()));
+
+    const uint64_t lookups = cacheHits.get() + cacheMisses.get();
+    diagnosticsLabels["Image cache hit rate"]->setText(lookups == 0 ? "-" :
+        QString("%1% (%2 of %3)")
+            .arg(100.0 * cacheHits.get() / lookups, 0, 'f', 1)
+            .arg(cacheHits.get())
+            .arg(lookups));
+
+    diagnosticsLabels["Downloaded"]->setText(locale.formattedDataSize(wireBytes.get()));
+
+    diagnosticsLabels["Library saves"]->setText(saves.get() == 0 ? "-" :
+        QString("%1, p50 %2, max %3")
+            .arg(saves.get())
+            .arg(ms(saveTime.percentile(0.50)), ms(saveTime.max())));
+
+    diagnosticsLabels["Library load time"]->setText(QString("%1 ms").arg(loadTime.get()));
+    diagnosticsLabels["Startup"]->setText(QString("first paint %1 ms, interactive %2 ms")
+        .arg(Metrics::gauge("startup.firstPaintMs").get())
+        .arg(Metrics::gauge("startup.interactiveMs").get()));
+    diagnosticsLabels["Library row build"]->setText(
+        QString("event loop blocked at most %1 ms")
+            .arg(Metrics::gauge("library.populateMaxBlockUs").get() / 1000.0, 0, 'f', 1));
+    diagnosticsLabels["Live widgets"]->setText(QString::number(QApplication::allWidgets().size()));
+    diagnosticsLabels["Resident memory"]->setText(
+        locale.formattedDataSize(Metrics::residentMemoryBytes()));
+}
 
-    // Update the application palette for dynamic colors
-    QPalette pal = palette();
-    pal.setColor(QPalette::Highlight, theme.accent);
-    pal.setColor(QPalette::Button, theme.sidebar);
-    QApplication::setPalette(pal);
+void MainWindow::applyTheme(const ThemeColors& theme)
+{
+    TRACE_SPAN("applyTheme", "ui");
+    // ThemeStyle draws everything from the palette, so a theme switch is a
+    // palette change: widgets repaint but nothing is re-polished
+    QApplication::setPalette(ThemeStyle::makePalette(
+        theme.background, theme.sidebar, theme.text, theme.accent));
+
+    // The sidebar container and both of its lists share the sidebar colours
+    sidebar->parentWidget()->setPalette(ThemeStyle::makeSidebarPalette(
+        theme.sidebar, theme.text, theme.accent));
 }
 
 void MainWindow::performSearch(bool loadingMore)
 {
+    TRACE_SPAN("performSearch", "ui");
     if (isSearching) return;
 
     if (!loadingMore) {
@@ -952,53 +1222,105 @@ void MainWindow::performSearch(bool loadingMore)
         statusLabel->setText("Please enter a search term");
         return;
         }
-        resultsList->clear();
+        ++searchGeneration;
+        offlineOffsets.clear();
+        totalResults = 0;
+        displayResults({}, false);
         resultsList->scrollToTop();  // Ensure we start at the top for new searches
     }
 
-    // Disable controls
-    isSearching = true;
-    searchBox->setEnabled(false);
-    searchButton->setEnabled(false);
-    loadMoreButton->setEnabled(false);
-    statusLabel->setText("Searching...");
+    // Serve whatever the local store already knows straight away; the live
+    // page is merged in when (and if) the network answers
+    SpotifyClient::SearchResult cached;
+    if (searchCache.lookupPage(currentSearchQuery, currentSearchOffset, cached) ||
+        searchCache.searchLocal(currentSearchQuery, currentSearchOffset, 10, cached)) {
+        totalResults = std::max(totalResults, cached.total);
+        displayResults(cached.albums, true);
+        statusLabel->setText(QString("Showing %1 of %2 saved results, updating...")
+            .arg(resultsList->count())
+            .arg(totalResults));
+        checkScrollPosition();
+    } else {
+        // Nothing to show yet, so block further requests until this one lands
+        isSearching = true;
+        searchBox->setEnabled(false);
+        searchButton->setEnabled(false);
+        loadMoreButton->setEnabled(false);
+        statusLabel->setText("Searching...");
+    }
 
-    try {
-        auto searchResult = spotify.searchAlbums(currentSearchQuery.toStdString(), currentSearchOffset);
-        
-        if (!loadingMore) {
-            totalResults = searchResult.total;
+    fetchLiveResults(currentSearchQuery, currentSearchOffset);
+}
+
+void MainWindow::fetchLiveResults(const QString& query, int offset)
+{
+    using SearchWatcher = QFutureWatcher<SpotifyClient::SearchResult>;
+    const quint64 generation = searchGeneration;
+    QElapsedTimer requestTimer;
+    requestTimer.start();
+
+    SearchWatcher* watcher = new SearchWatcher(this);
+    connect(watcher, &SearchWatcher::finished, this,
+            [this, watcher, query, offset, generation, requestTimer]() {
+        static Histogram& searchLatency = Metrics::histogram("search.latencyUs");
+        SpotifyClient::SearchResult result = watcher->result();
+        watcher->deleteLater();
+        if (result.succeeded) {
+            searchLatency.record(requestTimer.nsecsElapsed() / 1000);
+        }
+
+        if (result.succeeded) {
+            searchCache.storePage(query, offset, result);
+        }
+        if (generation != searchGeneration) return;  // A newer search replaced this one
+
+        isSearching = false;
+        searchBox->setEnabled(true);
+        searchButton->setEnabled(true);
+        loadMoreButton->setEnabled(true);
+
+        if (result.succeeded) {
+            offlineOffsets.removeAll(offset);
+            totalResults = std::max(totalResults, result.total);
+            displayResults(result.albums, true);
+            statusLabel->setText(QString("Showing %1 of %2 results")
+                .arg(resultsList->count())
+                .arg(totalResults));
+        } else {
+            if (!offlineOffsets.contains(offset)) offlineOffsets.append(offset);
+            reconnectTimer->start();
+            statusLabel->setText(resultsList->count() > 0
+                ? QString("Offline - showing %1 saved results").arg(resultsList->count())
+                : QString("Offline - no saved results for this search"));
         }
 
-        displayResults(searchResult.albums, loadingMore);
-        
-        // Update status
-        statusLabel->setText(QString("Showing %1 of %2 results")
-            .arg(resultsList->count())
-            .arg(totalResults));
-        
         // Check scroll position after new results are added
         checkScrollPosition();
-    }
-    catch (const std::exception& e) {
-        statusLabel->setText("Error performing search");
-        QMessageBox::critical(this, "Error", e.what());
-    }
+    });
 
-    // Re-enable controls
-    isSearching = false;
-    searchBox->setEnabled(true);
-    searchButton->setEnabled(true);
-    loadMoreButton->setEnabled(true);
+    watcher->setFuture(QtConcurrent::run([this, query, offset]() {
+        return spotify.searchAlbums(query.toStdString(), offset);
+    }));
+}
+
+void MainWindow::retryOfflineSearches()
+{
+    for (int offset : offlineOffsets) {
+        fetchLiveResults(currentSearchQuery, offset);
+    }
 }
 
 void MainWindow::displayResults(const std::vector<Album>& albums, bool append)
 {
     if (!append) {
         resultsList->clear();
+        displayedResultIds.clear();
     }
 
     for (const auto& album : albums) {
+        // Cached and live pages overlap; show each album once
+        if (!displayedResultIds.insert(album.id).second) continue;
+
         QListWidgetItem* item = new QListWidgetItem(resultsList);
         AlbumListItem* widget = new AlbumListItem(album, nullptr, false);  // false for search results
         
@@ -1011,29 +1333,55 @@ void MainWindow::displayResults(const std::vector<Album>& albums, bool append)
         resultsList->addItem(item);
         resultsList->setItemWidget(item, widget);
         
-        downloadAlbumArt(QString::fromStdString(album.image_url), widget);
+        // The row shows a 60px thumbnail, so the 640px cover would be wasted bandwidth
+        downloadAlbumArt(QString::fromStdString(album.imageUrlFor(thumbnailPixels())), widget);
     }
 }
 
-void MainWindow::downloadAlbumArt(const QString& url, AlbumListItem* item)
+QNetworkReply* MainWindow::downloadAlbumArt(const QString& url, AlbumListItem* item)
 {
-    QNetworkRequest request(url);
+    QNetworkRequest request = coverRequest(url);
+    // Cover URLs are content-addressed, so a cached copy never goes stale
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                         QNetworkRequest::PreferCache);
     QNetworkReply* reply = networkManager->get(request);
-    reply->setProperty("itemPtr", QVariant::fromValue(reinterpret_cast<quintptr>(item)));
+    // Guarded: clearing the results deletes rows whose covers are still in flight
+    reply->setProperty("item", QVariant::fromValue(QPointer<AlbumListItem>(item)));
+    return reply;
 }
 
 void MainWindow::handleImageDownloaded(QNetworkReply* reply)
 {
+    TRACE_SPAN("handleImageDownloaded", "network");
+    static Counter& cacheHits = Metrics::counter("images.cacheHits");
+    static Counter& cacheMisses = Metrics::counter("images.cacheMisses");
+
     if (reply->error() == QNetworkReply::NoError) {
         QByteArray data = reply->readAll();
+
+        if (reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool()) {
+            cacheHits.add();
+        } else {
+            cacheMisses.add();
+            recordCoverTransfer(imageTransferStats, reply, data.size());
+        }
+
         QPixmap pixmap;
         pixmap.loadFromData(data);
         
-        AlbumListItem* item = reinterpret_cast<AlbumListItem*>(
-            reply->property("itemPtr").value<quintptr>());
+        QPointer<AlbumListItem> item = reply->property("item").value<QPointer<AlbumListItem>>();
         if (item) {
             item->setImage(pixmap);
         }
+
+        // Large cover for an open details dialog; the dialog aborts the
+        // reply when it closes first, so the label is still alive here
+        QLabel* coverLabel = qobject_cast<QLabel*>(reply->property("coverLabel").value<QObject*>());
+        if (coverLabel && !pixmap.isNull()) {
+            pixmap.setDevicePixelRatio(coverLabel->devicePixelRatioF());
+            coverLabel->setPixmap(pixmap.scaled(coverLabel->size() * coverLabel->devicePixelRatioF(),
+                                                Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        }
     }
     reply->deleteLater();
 }
@@ -1043,31 +1391,89 @@ void MainWindow::showAlbumDetails(QListWidgetItem* item)
     AlbumListItem* widget = qobject_cast<AlbumListItem*>(
         item->listWidget()->itemWidget(item));
     if (!widget) return;
-    
-    const Album& album = widget->album();
-    
+    showAlbumDialog(widget->album());
+}
+
+void MainWindow::showAlbumDialog(const Album& album)
+{
     QDialog* detailsDialog = new QDialog(this);
+    detailsDialog->setAttribute(Qt::WA_DeleteOnClose);
     detailsDialog->setWindowTitle("Album Details");
     detailsDialog->setMinimumWidth(400);
 
     QGridLayout* layout = new QGridLayout(detailsDialog);
+
+    // Library rows keep the album they were built with, so prefer the stored
+    // copy which may have been enriched since
+    AlbumDetails details = album.details;
+    std::vector<ImageRendition> renditions = album.images;
+    QByteArray storedCover;
+    for (const auto& libAlbum : libraryAlbums) {
+        if (libAlbum.album.id == album.id) {
+            details = libAlbum.album.details;
+            if (renditions.empty()) renditions = libAlbum.album.images;
+            storedCover = libAlbum.imageData;
+            break;
+        }
+    }
+
+    // Show the stored thumbnail straight away and fetch the large rendition
+    // only now that someone actually wants to look at it
+    QLabel* coverLabel = new QLabel;
+    coverLabel->setFixedSize(DetailCoverSize, DetailCoverSize);
+    coverLabel->setAlignment(Qt::AlignCenter);
+    QPixmap thumbnail;
+    if (!storedCover.isEmpty() && thumbnail.loadFromData(storedCover)) {
+        coverLabel->setPixmap(thumbnail.scaled(coverLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    }
+    layout->addWidget(coverLabel, 0, 0, 1, 2, Qt::AlignHCenter);
+
+    Album coverSource = album;
+    coverSource.images = renditions;
+    QString coverUrl = QString::fromStdString(
+        coverSource.imageUrlFor(qCeil(DetailCoverSize * devicePixelRatioF())));
+    if (!coverUrl.isEmpty()) {
+        QNetworkReply* reply = downloadAlbumArt(coverUrl, nullptr);
+        reply->setProperty("coverLabel", QVariant::fromValue<QObject*>(coverLabel));
+        connect(coverLabel, &QObject::destroyed, reply, &QNetworkReply::abort);
+    }
+
+    layout->addWidget(new QLabel("Album:"), 1, 0);
+    layout->addWidget(new QLabel(QString::fromStdString(album.name)), 1, 1);
     
-    layout->addWidget(new QLabel("Album:"), 0, 0);
-    layout->addWidget(new QLabel(QString::fromStdString(album.name)), 0, 1);
-    
-    layout->addWidget(new QLabel("Artist:"), 1, 0);
-    layout->addWidget(new QLabel(QString::fromStdString(album.artist)), 1, 1);
+    layout->addWidget(new QLabel("Artist:"), 2, 0);
+    layout->addWidget(new QLabel(QString::fromStdString(album.artist)), 2, 1);
     
-    layout->addWidget(new QLabel("Release Date:"), 2, 0);
-    layout->addWidget(new QLabel(formatDate(album.release_date)), 2, 1);
+    layout->addWidget(new QLabel("Release Date:"), 3, 0);
+    layout->addWidget(new QLabel(formatDate(album.release_date)), 3, 1);
     
-    layout->addWidget(new QLabel("Spotify ID:"), 3, 0);
-    layout->addWidget(new QLabel(QString::fromStdString(album.id)), 3, 1);
+    layout->addWidget(new QLabel("Spotify ID:"), 4, 0);
+    layout->addWidget(new QLabel(QString::fromStdString(album.id)), 4, 1);
+
+    int row = 5;
+    if (details.artists.size() > 1) {
+        QLabel* artistsLabel = new QLabel(toQStringList(details.artists).join(", "));
+        artistsLabel->setWordWrap(true);
+        layout->addWidget(new QLabel("Artists:"), row, 0);
+        layout->addWidget(artistsLabel, row++, 1);
+    }
+    if (details.total_tracks > 0) {
+        layout->addWidget(new QLabel("Tracks:"), row, 0);
+        layout->addWidget(new QLabel(QString::number(details.total_tracks)), row++, 1);
+    }
+    if (!details.label.empty()) {
+        layout->addWidget(new QLabel("Label:"), row, 0);
+        layout->addWidget(new QLabel(QString::fromStdString(details.label)), row++, 1);
+    }
+    if (!details.genres.empty()) {
+        layout->addWidget(new QLabel("Genres:"), row, 0);
+        layout->addWidget(new QLabel(toQStringList(details.genres).join(", ")), row++, 1);
+    }
 
     QPushButton* closeButton = new QPushButton("Close");
     connect(closeButton, &QPushButton::clicked, detailsDialog, &QDialog::accept);
     
-    layout->addWidget(closeButton, 4, 0, 1, 2);
+    layout->addWidget(closeButton, row, 0, 1, 2);
     
     detailsDialog->exec();
 }
@@ -1081,131 +1487,266 @@ void MainWindow::switchToSearch()
 
 void MainWindow::switchToLibrary()
 {
-    if (stackedWidget && libraryPage) {
-        stackedWidget->setCurrentWidget(libraryPage);
-    }
+    ensureLibraryPage();
+    stackedWidget->setCurrentWidget(libraryPage);
 }
 
 void MainWindow::switchToSettings()
 {
-    if (stackedWidget && settingsPage) {
-        stackedWidget->setCurrentWidget(settingsPage);
-    }
+    ensureSettingsPage();
+    stackedWidget->setCurrentWidget(settingsPage);
+    updateDiagnostics();
+    diagnosticsTimer->start();
 }
 
-void MainWindow::addToLibrary(const Album& album, const QPixmap& albumArt)
+// The search row only holds a 60px thumbnail, too small for the grid, the
+// sidecar and the exports, so the library copy is the DetailCoverSize
+// rendition, stored as downloaded like the importer and refetchCovers do.
+// The row's thumbnail is the fallback when that download fails.
+void MainWindow::addToLibrary(const Album& album, const QPixmap& rowArt)
 {
-    QByteArray imageData;
-    QBuffer buffer(&imageData);
-    buffer.open(QIODevice::WriteOnly);
-    albumArt.save(&buffer, "PNG");
+    auto add = [this, album](const QByteArray& imageData) {
+        if (libraryAlbumIds.count(album.id)) return;  // Added again meanwhile
+        // Goes in at the end and the current sort puts it in place
+        LibraryMutation mutation;
+        mutation.add(LibraryAlbum(album, imageData));
+        changeLibrary(QString("Add \"%1\"").arg(QString::fromStdString(album.name)), mutation, true);
+        enrichLibrary();
+    };
+    auto rowArtPng = [rowArt]() {
+        QByteArray imageData;
+        if (rowArt.isNull()) return imageData;
+        QBuffer buffer(&imageData);
+        buffer.open(QIODevice::WriteOnly);
+        rowArt.save(&buffer, "PNG");
+        return imageData;
+    };
 
-    libraryAlbums.append(LibraryAlbum(album, imageData));
-    libraryAlbumIds.insert(album.id); // Insert into the set
-    
-    // Apply current sorting before refreshing display
-    sortLibrary(sortComboBox->currentIndex());
-    saveLibrary();  // Save after adding
+    const QString url = QString::fromStdString(album.imageUrlFor(DetailCoverSize));
+    if (url.isEmpty()) {
+        add(rowArtPng());
+        return;
+    }
+
+    if (!coverNetwork) coverNetwork = new QNetworkAccessManager(this);
+    QNetworkReply* reply = coverNetwork->get(coverRequest(url));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, add, rowArtPng]() {
+        reply->deleteLater();
+        const QByteArray data = reply->error() == QNetworkReply::NoError ? reply->readAll() : QByteArray();
+        if (data.isEmpty()) {
+            add(rowArtPng());
+            return;
+        }
+        recordCoverTransfer(imageTransferStats, reply, data.size());
+        add(data);
+    });
 }
 
 void MainWindow::refreshLibraryDisplay()
 {
+    if (!libraryPage) return;  // Built with the page on first visit
+    TRACE_SPAN("refreshLibraryDisplay", "ui");
     libraryList->clear();
-    for (const auto& libAlbum : libraryAlbums) {
+    libraryBuildCursor = 0;
+    applyLibraryFilter();
+
+    // The grid is virtual: applyLibraryFilter already gave it its rows
+    if (libraryGridMode()) {
+        libraryPopulateTimer->stop();
+        if (populateMonitor->isRunning()) populateMonitor->stop();
+        libraryProgress->hide();
+        emit libraryPopulated();
+        return;
+    }
+
+    populateElapsed.start();
+    if (!populateMonitor->isRunning()) populateMonitor->start();
+    libraryProgress->setRange(0, std::max<int>(1, libraryAlbums.size()));
+    libraryProgress->setValue(0);
+    libraryProgress->setVisible(!libraryAlbums.isEmpty());
+
+    // The first slice goes in now so the page never shows up empty
+    populateLibraryChunk();
+}
+
+// Rows are built in two steps: a cheap placeholder item sized like a real
+// row, then the AlbumListItem widget that makes it expensive. Each event-loop
+// turn spends at most LibrarySliceMs on: widgets for rows in the viewport,
+// then placeholders for every remaining album (so the scroll range is right
+// early), then widgets top-down. Row i always shows libraryAlbums[i].
+void MainWindow::populateLibraryChunk()
+{
+    TRACE_SPAN("populateLibraryChunk", "ui");
+    QElapsedTimer slice;
+    slice.start();
+    auto outOfTime = [&slice]() { return slice.nsecsElapsed() >= LibrarySliceMs * 1000000LL; };
+
+    // Rows on screen first, wherever the list is scrolled to
+    QModelIndex top;
+    const int middle = libraryList->viewport()->width() / 2;
+    for (int y = 0; !top.isValid() && y <= 2 * libraryList->spacing() + 1; ++y) {
+        top = libraryList->indexAt(QPoint(middle, y));
+    }
+    const int viewportBottom = libraryList->viewport()->height();
+    for (int row = top.isValid() ? top.row() : 0; row < libraryList->count() && !outOfTime(); ++row) {
+        QListWidgetItem* item = libraryList->item(row);
+        if (item->isHidden()) continue;
+        if (libraryList->visualItemRect(item).top() > viewportBottom) break;
+        buildLibraryRow(row);
+    }
+
+    if (!libraryRowHint.isValid() && !libraryAlbums.isEmpty()) {
+        AlbumListItem probe(libraryAlbums.first().album, nullptr, true);
+        probe.setAddToLibraryVisible(false);
+        libraryRowHint = probe.sizeHint();
+    }
+    while (libraryList->count() < libraryAlbums.size() && !outOfTime()) {
+        const LibraryAlbum& libAlbum = libraryAlbums[libraryList->count()];
         QListWidgetItem* item = new QListWidgetItem(libraryList);
-        AlbumListItem* widget = new AlbumListItem(libAlbum.album, nullptr, true);  // true for library view
-        
-        QPixmap pixmap;
-        pixmap.loadFromData(libAlbum.imageData);
-        widget->setImage(pixmap);
-        widget->setAddToLibraryVisible(false);
-        widget->setRating(libAlbum.album.rating);
-        
-        item->setSizeHint(widget->sizeHint());
-        libraryList->addItem(item);
-        libraryList->setItemWidget(item, widget);
+        item->setSizeHint(libraryRowHint);
+        item->setHidden(!libraryMatches.test(libraryIndex.docId(libAlbum.album.id)));
+    }
+
+    while (libraryBuildCursor < libraryList->count() && !outOfTime()) {
+        buildLibraryRow(libraryBuildCursor++);
+    }
+
+    libraryProgress->setValue(libraryBuildCursor);
+    if (!isLibraryPopulated()) {
+        libraryPopulateTimer->start();
+        return;
+    }
+
+    libraryPopulateTimer->stop();
+    libraryProgress->hide();
+    populateMonitor->stop();
+    libraryPopulateMs = populateElapsed.nsecsElapsed() / 1e6;
+    libraryPopulateMaxBlockMs = populateMonitor->maxBlockMs();
+    Metrics::gauge("library.populateMaxBlockUs").set(qint64(libraryPopulateMaxBlockMs * 1000));
+    if (sidecarMisses > 0) {
+        sidecarMisses = 0;
+        rebuildThumbnailSidecar();
     }
+    qInfo().noquote() << QString("library: built %1 rows in %2 ms, event loop blocked at most %3 ms")
+        .arg(libraryList->count())
+        .arg(libraryPopulateMs, 0, 'f', 1)
+        .arg(libraryPopulateMaxBlockMs, 0, 'f', 1);
+    emit libraryPopulated();
 }
 
-void MainWindow::saveLibrary()
+void MainWindow::buildLibraryRow(int row)
 {
-    QString libraryPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir().mkpath(libraryPath);
-    QString filePath = libraryPath + "/library.dat";
+    QListWidgetItem* item = libraryList->item(row);
+    if (libraryList->itemWidget(item)) return;
+
+    const LibraryAlbum& libAlbum = libraryAlbums[row];
+    AlbumListItem* widget = new AlbumListItem(libAlbum.album, nullptr, true);  // true for library view
     
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        QDataStream out(&file);
-        out.setVersion(QDataStream::Qt_6_0);
-        
-        const quint32 magic = 0x41434D47;
-        const quint32 version = 2;  // Version 2 includes ratings
-        out << magic << version;
-        out << quint32(libraryAlbums.size());
-        
-        for (const auto& libAlbum : libraryAlbums) {
-            out << QString::fromStdString(libAlbum.album.name)
-                << QString::fromStdString(libAlbum.album.artist)
-                << QString::fromStdString(libAlbum.album.id)
-                << QString::fromStdString(libAlbum.album.release_date)
-                << QString::fromStdString(libAlbum.album.image_url)
-                << libAlbum.imageData
-                << qint32(libAlbum.album.rating);  // Explicitly save as qint32
+    static Counter& sidecarHits = Metrics::counter("images.sidecarHits");
+    static Counter& sidecarDecodes = Metrics::counter("images.sidecarMisses");
+
+    QPixmap pixmap;
+    const quint64 coverKey = ThumbnailSidecar::coverKey(libAlbum.imageData);
+    QImage thumbnail = thumbnailSidecar.image(libAlbum.album.id, coverKey);
+    if (!thumbnail.isNull()) {
+        sidecarHits.add();
+        pixmap = QPixmap::fromImage(thumbnail);
+        // Stored at most MaxPixels square, so not always at the screen's ratio
+        pixmap.setDevicePixelRatio(qreal(thumbnailSidecar.pixels()) / ThumbnailSize);
+    } else {
+        sidecarDecodes.add();
+        if (!libAlbum.imageData.isEmpty() && !thumbnailSidecar.contains(libAlbum.album.id, coverKey)) {
+            ++sidecarMisses;
         }
-        file.close();
+        pixmap.loadFromData(libAlbum.imageData);
     }
+    widget->setImage(pixmap);
+    widget->setAddToLibraryVisible(false);
+    widget->setRating(libAlbum.album.rating);
+    
+    item->setSizeHint(widget->sizeHint());
+    libraryList->setItemWidget(item, widget);
+}
+
+int MainWindow::thumbnailPixels() const
+{
+    return qCeil(ThumbnailSize * devicePixelRatioF());
+}
+
+// Brings library.thumbs up to date in the background: covers it has not
+// seen are appended, and only a missing, outgrown or other-size file is
+// rewritten whole, copying the thumbnails it already had. The running
+// session keeps its old mapping until the file is complete.
+void MainWindow::rebuildThumbnailSidecar()
+{
+    if (sidecarWatcher->isRunning()) return;
+
+    // Hashing the covers to find the new ones is left to the worker
+    QVector<ThumbnailSidecar::Entry> entries;
+    entries.reserve(libraryAlbums.size());
+    for (const auto& libAlbum : libraryAlbums) entries.push_back({libAlbum.album.id, libAlbum.imageData});
+    const QString path = ThumbnailSidecar::pathFor(libraryStore.path());
+    const int pixels = thumbnailPixels();
+    sidecarWatcher->setProperty("pixels", pixels);
+    sidecarWatcher->setFuture(QtConcurrent::run([path, pixels, entries]() {
+        return ThumbnailSidecar::append(path, pixels, entries) || ThumbnailSidecar::write(path, pixels, entries);
+    }));
+}
+
+void MainWindow::scheduleLibrarySave()
+{
+    libraryDirty = true;
+    librarySaveTimer->start();
+}
+
+void MainWindow::saveLibrary()
+{
+    librarySaveTimer->stop();
+    if (!libraryDirty) return;
+    TRACE_SPAN("saveLibrary", "storage");
+    // A failed write stays dirty and is tried again with the next change or at exit
+    libraryDirty = !libraryStore.save(libraryAlbums);
 }
 
 void MainWindow::loadLibrary()
 {
-    QString libraryPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QString filePath = libraryPath + "/library.dat";
-    
-    if (QFile::exists(filePath)) {
-        QFile file(filePath);
-        if (file.open(QIODevice::ReadOnly)) {
-            QDataStream in(&file);
-            in.setVersion(QDataStream::Qt_6_0);
-            
-            quint32 magic, version;
-            in >> magic >> version;
-            
-            if (magic != 0x41434D47) return;
-            
-            libraryAlbums.clear();
-            libraryAlbumIds.clear();
-            
-            quint32 size;
-            in >> size;
-            
-            for (quint32 i = 0; i < size; ++i) {
-                QString name, artist, id, release_date, image_url;
-                QByteArray imageData;
-                qint32 rating = 0;  // Use qint32 for consistency
-                
-                in >> name >> artist >> id >> release_date >> image_url >> imageData;
-                
-                if (version >= 2) {
-                    in >> rating;
-                }
-                
-                Album album(name.toStdString(), artist.toStdString(), 
-                           id.toStdString(), release_date.toStdString(), 
-                           image_url.toStdString());
-                album.rating = rating;
-                libraryAlbums.append(LibraryAlbum(album, imageData));
-                libraryAlbumIds.insert(album.id);
-            }
-            
-            file.close();
-            refreshLibraryDisplay();
+    TRACE_SPAN("loadLibrary", "storage");
+    QElapsedTimer timer;
+    timer.start();
+    if (!libraryStore.load(libraryAlbums)) {
+        if (libraryStore.isDamaged()) {
+            QTimer::singleShot(0, this, [this]() {
+                QMessageBox::warning(this, "Library",
+                    QString("%1 is damaged and was not loaded. It will not be overwritten, "
+                            "so changes made in this session will not be saved.")
+                        .arg(QDir::toNativeSeparators(libraryStore.path())));
+            });
         }
+        return;
     }
+    thumbnailSidecar.open(thumbnailPixels());
+
+    libraryAlbumIds.clear();
+    libraryIndex.clear();
+    libraryFacets.clear();
+
+    for (const auto& libAlbum : libraryAlbums) {
+        libraryAlbumIds.insert(libAlbum.album.id);
+        libraryFacets.add(libraryIndex.add(libAlbum.album), libAlbum.album);
+    }
+
+    refreshLibraryDisplay();
+    libraryLoadMs = timer.elapsed();
+    Metrics::gauge("library.loadMs").set(libraryLoadMs);
+
+    updateCoverTheme();
+    computeColorSignatures();
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     saveLibrary();
+    searchCache.save();
     event->accept();
 }
 
@@ -1220,101 +1761,599 @@ QString MainWindow::formatDate(const std::string& dateStr)
 
 void MainWindow::sortLibrary(int sortIndex)
 {
-    switch (sortIndex) {
-        case 0: // Artist
-            std::sort(libraryAlbums.begin(), libraryAlbums.end(),
-                [](const LibraryAlbum& a, const LibraryAlbum& b) {
-                    QString artistA = QString::fromStdString(a.album.artist).toLower();
-                    QString artistB = QString::fromStdString(b.album.artist).toLower();
-                    
-                    if (artistA == artistB) {
-                        // If same artist, sort by release date (newest first)
-                        QDate dateA = QDate::fromString(QString::fromStdString(a.album.release_date), "yyyy-MM-dd");
-                        QDate dateB = QDate::fromString(QString::fromStdString(b.album.release_date), "yyyy-MM-dd");
-                        if (!dateA.isValid() || !dateB.isValid()) {
-                            return a.album.release_date > b.album.release_date;
-                        }
-                        return dateA > dateB;
-                    }
-                    return artistA < artistB;
-                });
-            break;
-            
-        case 1: // Album Name
-            std::sort(libraryAlbums.begin(), libraryAlbums.end(),
-                [](const LibraryAlbum& a, const LibraryAlbum& b) {
-                    return QString::fromStdString(a.album.name).toLower() < 
-                           QString::fromStdString(b.album.name).toLower();
-                });
-            break;
-            
-        case 2: // Release Date
-            std::sort(libraryAlbums.begin(), libraryAlbums.end(),
-                [](const LibraryAlbum& a, const LibraryAlbum& b) {
-                    QDate dateA = QDate::fromString(QString::fromStdString(a.album.release_date), "yyyy-MM-dd");
-                    QDate dateB = QDate::fromString(QString::fromStdString(b.album.release_date), "yyyy-MM-dd");
-                    if (!dateA.isValid() || !dateB.isValid()) {
-                        return a.album.release_date < b.album.release_date;
-                    }
-                    return dateA < dateB;
-                });
-            break;
-            
-        case 3: // Rating (highest to lowest)
-            std::sort(libraryAlbums.begin(), libraryAlbums.end(),
-                [](const LibraryAlbum& a, const LibraryAlbum& b) {
-                    // Put unrated albums at the bottom
-                    if (a.album.rating == 0 && b.album.rating > 0) return false;
-                    if (b.album.rating == 0 && a.album.rating > 0) return true;
-                    
-                    // Sort by rating (highest to lowest)
-                    if (a.album.rating != b.album.rating) {
-                        return a.album.rating > b.album.rating;
-                    }
-                    
-                    // If ratings are equal, sort by artist name
-                    return QString::fromStdString(a.album.artist).toLower() < 
-                           QString::fromStdString(b.album.artist).toLower();
-                });
-            break;
+    TRACE_SPAN("sortLibrary", "ui");
+    if (sortIndex == SortByColor) {
+        // The first time round there is no colour yet; activated asks for one
+        if (libraryColorReference.valid) {
+            sortLibraryAlbumsBySimilarity(libraryAlbums, libraryColorReference);
+        } else if (libraryBrowseColor.isValid()) {
+            sortLibraryAlbumsByColor(libraryAlbums, libraryBrowseColor.rgb() & 0xFFFFFF);
+        } else {
+            return;
+        }
+    } else {
+        sortLibraryAlbums(libraryAlbums, static_cast<LibrarySortMode>(sortIndex));
     }
-    
+    lastSortIndex = sortIndex;
+    ++libraryOrder;
     refreshLibraryDisplay();
 }
 
-void MainWindow::removeSelectedAlbum()
+void MainWindow::pickBrowseColor()
 {
-    QListWidgetItem* currentItem = libraryList->currentItem();
-    if (!currentItem) return;
-    
-    int row = libraryList->row(currentItem);
-    if (row >= 0 && row < static_cast<int>(libraryAlbums.size())) {
-        // Remove the album ID from the set
-        libraryAlbumIds.erase(libraryAlbums[row].album.id);
-        
-        // Remove from both UI and data
-        delete libraryList->takeItem(row);
-        libraryAlbums.remove(row);
-        saveLibrary(); // Save changes to file
+    QColor color = QColorDialog::getColor(
+        libraryBrowseColor.isValid() ? libraryBrowseColor : QColor("#C0392B"), this, "Browse by Colour");
+    if (!color.isValid()) {
+        // Cancelled before any colour was chosen: go back to the last order
+        if (lastSortIndex != SortByColor) sortComboBox->setCurrentIndex(lastSortIndex);
+        return;
+    }
+    libraryBrowseColor = color;
+    libraryColorReference = ColorSignature();
+    sortLibrary(SortByColor);
+}
+
+int MainWindow::libraryRowOf(const std::string& albumId) const
+{
+    for (int row = 0; row < libraryAlbums.size(); ++row) {
+        if (libraryAlbums[row].album.id == albumId) return row;
+    }
+    return -1;
+}
+
+void MainWindow::showSimilarCovers(const std::string& albumId)
+{
+    const int row = libraryRowOf(albumId);
+    if (row < 0) return;
+    libraryColorReference = libraryAlbums[row].colors;
+    {
+        QSignalBlocker blocker(sortComboBox);
+        sortComboBox->setCurrentIndex(SortByColor);
+    }
+    sortLibrary(SortByColor);
+}
+
+// Decodes a cover small and reduces it to its colour signature. Runs on
+// the thread pool.
+static ColorSignature coverColorSignature(const QByteArray& encoded)
+{
+    QBuffer buffer;
+    buffer.setData(encoded);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    const QSize size = reader.size();
+    if (size.isValid() && (size.width() > 64 || size.height() > 64)) {
+        reader.setScaledSize(size.scaled(64, 64, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) return ColorSignature();
+    image = image.convertToFormat(QImage::Format_RGB32);
+    // 32-bit scanlines are never padded, so the pixels are one run
+    return ColorSignature::fromPixels(reinterpret_cast<const uint32_t*>(image.constBits()),
+                                      size_t(image.width()) * image.height());
+}
+
+// Signatures for every album that lacks one, on the thread pool. They are
+// saved with the library, so each cover is only ever done once.
+void MainWindow::computeColorSignatures()
+{
+    if (colorWatcher->isRunning()) return;
+
+    QVector<QByteArray> covers;
+    colorPending.clear();
+    for (const auto& libAlbum : libraryAlbums) {
+        const QString id = QString::fromStdString(libAlbum.album.id);
+        if (libAlbum.colors.valid || libAlbum.imageData.isEmpty() || colorlessCovers.contains(id)) continue;
+        colorPending.append(id);
+        covers.append(libAlbum.imageData);
+    }
+    if (!covers.isEmpty()) {
+        colorWatcher->setFuture(QtConcurrent::mapped(covers, &coverColorSignature));
+    }
+}
+
+// The seed is the hue the covers share most, favouring well-rated albums
+// and colours that fill their cover; greys and near-black say nothing
+void MainWindow::updateCoverTheme()
+{
+    if (coverThemeIndex < 0) return;
+
+    const int HueBins = 36;
+    double weights[HueBins] = {};
+    double red[HueBins] = {}, green[HueBins] = {}, blue[HueBins] = {};
+    for (const auto& libAlbum : libraryAlbums) {
+        if (!libAlbum.colors.valid) continue;
+        for (int i = 0; i < ColorSignature::DominantCount; ++i) {
+            const QColor color = QColor::fromRgb(libAlbum.colors.dominant[i]);
+            if (color.hsvSaturationF() < 0.25 || color.valueF() < 0.2) continue;
+            const double weight = libAlbum.colors.share[i] * (libAlbum.album.rating + 1);
+            const int bin = color.hsvHue() * HueBins / 360;
+            weights[bin] += weight;
+            red[bin] += weight * color.redF();
+            green[bin] += weight * color.greenF();
+            blue[bin] += weight * color.blueF();
+        }
+    }
+    const int best = int(std::max_element(weights, weights + HueBins) - weights);
+    if (weights[best] <= 0) return;
+
+    const QColor seed = QColor::fromRgbF(red[best] / weights[best], green[best] / weights[best],
+                                         blue[best] / weights[best]);
+    themes[coverThemeIndex] = themeFromSeed(themes[coverThemeIndex].name, seed);
+    if (themeList) {
+        themeList->item(coverThemeIndex)->setIcon(QIcon(themePreview(themes[coverThemeIndex])));
+    }
+    if (savedThemeIndex() == coverThemeIndex) applyTheme(themes[coverThemeIndex]);
+}
+
+// A light theme in the seed's hue with the seed itself as the accent
+MainWindow::ThemeColors MainWindow::themeFromSeed(const QString& name, const QColor& seed)
+{
+    const int hue = qMax(0, seed.hslHue());
+    return ThemeColors(name,
+        QColor::fromHslF(hue / 360.0, 0.30, 0.95),  // background
+        QColor::fromHslF(hue / 360.0, 0.40, 0.84),  // sidebar
+        QColor::fromHslF(hue / 360.0, 0.35, 0.16),  // text
+        QColor::fromHslF(hue / 360.0, qMax(0.55, seed.hslSaturationF()), 0.42)  // accent
+    );
+}
+
+std::vector<std::string> MainWindow::selectedLibraryAlbumIds() const
+{
+    QVector<int> rows;
+    if (libraryGridMode()) {
+        for (const QModelIndex& index : libraryGrid->selectionModel()->selectedIndexes()) {
+            rows.append(index.data(LibraryGridModel::AlbumIndexRole).toInt());
+        }
+    } else {
+        // Select All also takes rows the filter hides
+        for (const QModelIndex& index : libraryList->selectionModel()->selectedIndexes()) {
+            if (!libraryList->isRowHidden(index.row())) rows.append(index.row());
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+
+    std::vector<std::string> ids;
+    ids.reserve(rows.size());
+    for (int row : rows) ids.push_back(libraryAlbums[row].album.id);
+    return ids;
+}
+
+// The menu acts on the whole selection, or on the clicked album alone when
+// it is outside the selection. Actions carry ids, not rows, since a batch
+// landing while the menu is open can move albums.
+void MainWindow::showLibraryContextMenu(const QPoint& globalPos, int clickedAlbum)
+{
+    std::vector<std::string> ids = selectedLibraryAlbumIds();
+    if (clickedAlbum >= 0) {
+        const std::string& clickedId = libraryAlbums[clickedAlbum].album.id;
+        if (std::find(ids.begin(), ids.end(), clickedId) == ids.end()) ids = {clickedId};
+    }
+    if (ids.empty()) return;
+    const int count = int(ids.size());
+
+    QMenu contextMenu(tr("Context menu"), this);
+    QAction* removeAction = contextMenu.addAction(
+        count == 1 ? QString("Remove Album") : QString("Remove %1 Albums").arg(count));
+    connect(removeAction, &QAction::triggered, this, [this, ids]() {
+        removeLibraryAlbums(ids);
+    });
+
+    QMenu* rateMenu = contextMenu.addMenu(count == 1 ? QString("Rate") : QString("Rate %1 Albums").arg(count));
+    for (int rating = 1; rating <= 10; ++rating) {
+        connect(rateMenu->addAction(QString("%1/10").arg(rating)), &QAction::triggered, this,
+                [this, ids, rating]() { rateLibraryAlbums(ids, rating); });
+    }
+    rateMenu->addSeparator();
+    connect(rateMenu->addAction("Clear Rating"), &QAction::triggered, this, [this, ids]() {
+        rateLibraryAlbums(ids, 0);
+    });
+
+    QAction* coverAction = contextMenu.addAction(coverRefetchPending > 0
+        ? QString("Re-fetching Cover Art...")
+        : count == 1 ? QString("Re-fetch Cover Art") : QString("Re-fetch %1 Covers").arg(count));
+    coverAction->setEnabled(coverRefetchPending == 0);
+    connect(coverAction, &QAction::triggered, this, [this, ids]() {
+        refetchCovers(ids);
+    });
+
+    if (clickedAlbum >= 0 && count == 1) {
+        contextMenu.addSeparator();
+        QAction* similarAction = contextMenu.addAction("More Like This Cover");
+        similarAction->setEnabled(libraryAlbums[clickedAlbum].colors.valid);
+        // By id: rows move if an import or undo re-sorts while the menu is open
+        const std::string albumId = libraryAlbums[clickedAlbum].album.id;
+        connect(similarAction, &QAction::triggered, this, [this, albumId]() {
+            showSimilarCovers(albumId);
+        });
+    }
+
+    contextMenu.exec(globalPos);
+}
+
+// Applies the change and makes it the next undo step
+void MainWindow::changeLibrary(const QString& text, const LibraryMutation& mutation, bool sortAdded)
+{
+    LibraryMutation inverse = applyLibraryMutation(mutation, sortAdded);
+    if (!inverse.isEmpty()) undoStack->push(new LibraryCommand(this, text, std::move(inverse)));
+}
+
+// The whole batch is one pass over the library, then one update of each
+// view, however many albums it covers. The save is scheduled, so a run of
+// batches (clicks, undo, redo) shares one atomic write.
+LibraryMutation MainWindow::applyLibraryMutation(const LibraryMutation& mutation, bool sortAdded)
+{
+    TRACE_SPAN("applyLibraryMutation", "storage");
+    LibraryMutation inverse;
+    const LibraryMutation::Applied applied =
+        mutation.apply(libraryAlbums, libraryAlbumIds, libraryIndex, libraryFacets, &inverse);
+    if (applied.isEmpty()) return inverse;
+
+    for (int row : applied.coverRows) {
+        colorlessCovers.remove(QString::fromStdString(libraryAlbums[row].album.id));
+    }
+
+    // A sort rebuilds the rows anyway, so only patch them when there is none
+    const bool resort = (sortAdded && !applied.addedRows.empty())
+        || (!applied.ratedRows.empty() && lastSortIndex == SortByRating);
+    if (libraryPage) {
+        for (int row : applied.coverRows) {
+            thumbnailCache->remove(QString::fromStdString(libraryAlbums[row].album.id));
+        }
+        if (!resort && !libraryGridMode()) updateLibraryRows(applied);
+    }
+
+    if (resort) {
+        sortLibrary(lastSortIndex);
+    } else {
+        applyLibraryFilter();
+    }
+    scheduleLibrarySave();
+    if (!applied.coverRows.empty() || !applied.addedRows.empty()) computeColorSignatures();
+    return inverse;
+}
+
+// Patches the list to match libraryAlbums after a mutation. Rows exist
+// only up to count(); rows above libraryBuildCursor have their widgets.
+void MainWindow::updateLibraryRows(const LibraryMutation::Applied& applied)
+{
+    // Removed rows go a contiguous run at a time, bottom up, so the rows
+    // above keep their places
+    const std::vector<int>& removed = applied.removedRows;
+    for (size_t end = removed.size(); end > 0;) {
+        size_t start = end - 1;
+        while (start > 0 && removed[start - 1] == removed[start] - 1) --start;
+        const int first = removed[start];
+        const int count = int(end - start);
+        if (first < libraryList->count()) {
+            libraryList->model()->removeRows(first, qMin(count, libraryList->count() - first));
+        }
+        libraryBuildCursor -= qBound(0, libraryBuildCursor - first, count);
+        end = start;
+    }
+
+    // Rows past count() are left to populateLibraryChunk
+    for (int row : applied.addedRows) {
+        if (row > libraryList->count()) break;
+        QListWidgetItem* item = new QListWidgetItem;
+        item->setSizeHint(libraryRowHint);
+        libraryList->insertItem(row, item);
+        if (row <= libraryBuildCursor) {
+            buildLibraryRow(row);
+            ++libraryBuildCursor;
+        }
+    }
+
+    for (int row : applied.ratedRows) {
+        if (row >= libraryList->count()) break;
+        auto* widget = qobject_cast<AlbumListItem*>(libraryList->itemWidget(libraryList->item(row)));
+        if (widget) widget->setRating(libraryAlbums[row].album.rating);
+    }
+    for (int row : applied.coverRows) {
+        QListWidgetItem* item = row < libraryList->count() ? libraryList->item(row) : nullptr;
+        if (item && libraryList->itemWidget(item)) {
+            libraryList->removeItemWidget(item);
+            buildLibraryRow(row);
+        }
+    }
+}
+
+void MainWindow::removeLibraryAlbums(const std::vector<std::string>& albumIds)
+{
+    LibraryMutation mutation;
+    for (const std::string& id : albumIds) mutation.remove(id);
+    changeLibrary(albumIds.size() == 1 ? QString("Remove Album")
+                                       : QString("Remove %1 Albums").arg(albumIds.size()), mutation);
+}
+
+void MainWindow::rateLibraryAlbums(const std::vector<std::string>& albumIds, int rating)
+{
+    LibraryMutation mutation;
+    for (const std::string& id : albumIds) mutation.setRating(id, rating);
+    const QString albums = albumIds.size() == 1 ? QString("Album") : QString("%1 Albums").arg(albumIds.size());
+    changeLibrary(rating == 0 ? "Clear Rating of " + albums : "Rate " + albums, mutation);
+}
+
+// Covers are fetched at the size imports store them. They collect in
+// coverRefetch and go in as one change when the last reply is in; a
+// failed download keeps the old cover.
+void MainWindow::refetchCovers(const std::vector<std::string>& albumIds)
+{
+    if (coverRefetchPending > 0) return;
+    if (!coverNetwork) coverNetwork = new QNetworkAccessManager(this);
+
+    const std::unordered_set<std::string> wanted(albumIds.begin(), albumIds.end());
+    coverRefetch = LibraryMutation();
+    for (const auto& libAlbum : libraryAlbums) {
+        if (!wanted.count(libAlbum.album.id)) continue;
+        const QString url = QString::fromStdString(libAlbum.album.imageUrlFor(DetailCoverSize));
+        if (url.isEmpty()) continue;
+
+        QNetworkReply* reply = coverNetwork->get(coverRequest(url));
+        ++coverRefetchPending;
+        connect(reply, &QNetworkReply::finished, this, [this, reply, id = libAlbum.album.id]() {
+            reply->deleteLater();
+            const QByteArray data = reply->error() == QNetworkReply::NoError ? reply->readAll() : QByteArray();
+            if (!data.isEmpty()) {
+                recordCoverTransfer(imageTransferStats, reply, data.size());
+                coverRefetch.setCover(id, data);
+            }
+            if (--coverRefetchPending == 0) {
+                changeLibrary(coverRefetch.size() == 1 ? QString("Re-fetch Cover")
+                              : QString("Re-fetch %1 Covers").arg(coverRefetch.size()), coverRefetch);
+                coverRefetch = LibraryMutation();
+            }
+        });
     }
 }
 
 MainWindow::~MainWindow()
 {
+    // Background searches, enrichment and imports use spotify. Aborting
+    // ends their transfers and rate-limit waits, so they finish promptly.
+    stopEnrichment = true;
+    spotify.abortTransfers();
+    QThreadPool::globalInstance()->waitForDone();
     saveLibrary();  // Ensure library is saved on destruction
+    searchCache.save();
 }
 
 void MainWindow::updateAlbumRating(const std::string& albumId, int rating) {
+    rateLibraryAlbums({albumId}, rating);
+}
+
+void MainWindow::enrichLibrary()
+{
+    if (enrichmentWatcher->isRunning()) {
+        enrichmentPending = true;
+        return;
+    }
+
+    // Albums that came back empty wait out a doubling backoff, so ids the
+    // API has no object for, or a pass made offline, are not re-requested
+    // on every start and import
+    const int64_t now = QDateTime::currentSecsSinceEpoch();
+    std::vector<std::string> ids;
+    for (const auto& libAlbum : libraryAlbums) {
+        if (libAlbum.album.details.enrichmentDue(now)) {
+            ids.push_back(libAlbum.album.id);
+        }
+    }
+    if (ids.empty()) return;
+
+    // One request per 20 albums instead of one per album. getSeveralAlbums
+    // runs at background priority, so the user's searches go first.
+    enrichmentWatcher->setFuture(QtConcurrent::run([this, ids]() {
+        const size_t batchSize = SpotifyClient::MaxAlbumsPerRequest;
+        for (size_t i = 0; i < ids.size() && !stopEnrichment; i += batchSize) {
+            std::vector<std::string> batch(ids.begin() + i,
+                                           ids.begin() + std::min(ids.size(), i + batchSize));
+            std::vector<Album> albums;
+            spotify.getSeveralAlbums(batch, albums);
+            if (stopEnrichment) break;  // Aborted on shutdown, not a failure
+            QMetaObject::invokeMethod(this, [this, batch, albums]() {
+                applyAlbumDetails(batch, albums);
+            }, Qt::QueuedConnection);
+        }
+    }));
+}
+
+void MainWindow::applyAlbumDetails(const std::vector<std::string>& requested, const std::vector<Album>& albums)
+{
+    std::unordered_map<std::string, const Album*> byId;
+    for (const auto& album : albums) {
+        byId[album.id] = &album;
+    }
+    const std::unordered_set<std::string> asked(requested.begin(), requested.end());
+    const int64_t now = QDateTime::currentSecsSinceEpoch();
+
     for (auto& libAlbum : libraryAlbums) {
-        if (libAlbum.album.id == albumId) {
-            libAlbum.album.rating = rating;
-            break;
+        auto it = byId.find(libAlbum.album.id);
+        if (it != byId.end()) {
+            libAlbum.album.details = it->second->details;
+        } else if (asked.count(libAlbum.album.id) && !libAlbum.album.details.enriched) {
+            ++libAlbum.album.details.failedAttempts;
+            libAlbum.album.details.lastAttempt = now;
         }
     }
-    saveLibrary();
-    
-    // If currently sorted by rating, refresh the display
-    if (sortComboBox->currentIndex() == 3) {
-        sortLibrary(3);
+    // Per batch, so quitting mid-pass keeps what has come in so far
+    scheduleLibrarySave();
+}
+
+void MainWindow::applyLibraryFilter()
+{
+    if (!libraryPage) return;
+    const QString query = libraryFilterBox->text();
+    DocBitmap textMatches = libraryIndex.allDocs();
+    std::vector<LibraryIndex::FuzzyMatch> ranked;
+    if (!query.trimmed().isEmpty()) {
+        textMatches = libraryIndex.search(query);
+
+        // Nothing matches exactly, so assume a typo and fall back to fuzzy matching
+        if (!textMatches.any()) {
+            ranked = libraryIndex.fuzzySearch(query);
+            for (const auto& match : ranked) textMatches.set(match.doc);
+        }
+    }
+
+    const LibraryFacets::Selection selection = currentFacetSelection();
+    libraryMatches = libraryFacets.filter(textMatches, selection);
+    updateFacetCounts(textMatches, selection);
+
+    // The grid shows fuzzy matches closest first; the list's rows are the
+    // library's own rows, so it keeps the library order
+    QVector<int> gridRows;
+    if (libraryGridMode()) {
+        gridRows.reserve(libraryMatches.count());
+        if (!ranked.empty()) {
+            std::vector<int> rowOfDoc(libraryIndex.docCapacity(), -1);
+            for (int row = 0; row < libraryAlbums.size(); ++row) {
+                const LibraryIndex::DocId doc = libraryIndex.docId(libraryAlbums[row].album.id);
+                if (doc < rowOfDoc.size()) rowOfDoc[doc] = row;
+            }
+            for (const auto& match : ranked) {
+                if (libraryMatches.test(match.doc) && rowOfDoc[match.doc] >= 0) {
+                    gridRows.append(rowOfDoc[match.doc]);
+                }
+            }
+        } else {
+            for (int row = 0; row < libraryAlbums.size(); ++row) {
+                if (libraryMatches.test(libraryIndex.docId(libraryAlbums[row].album.id))) {
+                    gridRows.append(row);
+                }
+            }
+        }
+    }
+    libraryGridModel->setRows(std::move(gridRows));
+
+    // Rows are built in libraryAlbums order; rows still to be built pick up
+    // libraryMatches as they are created
+    for (int row = 0; row < libraryList->count(); ++row) {
+        bool visible = libraryMatches.test(libraryIndex.docId(libraryAlbums[row].album.id));
+        libraryList->item(row)->setHidden(!visible);
+    }
+    updateLibraryCount();
+}
+
+LibraryFacets::Selection MainWindow::currentFacetSelection() const
+{
+    LibraryFacets::Selection selection;
+    if (ratingFacetBox->currentData().isValid()) {
+        selection.rating = ratingFacetBox->currentData().toInt();
+    }
+    if (decadeFacetBox->currentData().isValid()) {
+        selection.decade = decadeFacetBox->currentData().toInt();
+    }
+    if (artistFacetBox->currentData().isValid()) {
+        selection.artist = artistFacetBox->currentData().toString();
+    }
+    return selection;
+}
+
+// Brings a facet combo to "label (count)" entries in place: labels are
+// rewritten only when a count changed and items are inserted or removed
+// only for values that appeared or vanished, so typing in the filter does
+// not rebuild thousands of artist items. The current choice stays even when
+// its count has dropped to zero. With more than limit values only the
+// largest are listed; the text filter narrows to the rest.
+template <typename Key, typename LabelFn>
+static void fillFacetBox(QComboBox* box, const QString& anyText,
+                         const std::vector<std::pair<Key, uint32_t>>& counts, LabelFn label,
+                         size_t limit = std::numeric_limits<size_t>::max())
+{
+    const QVariant selected = box->currentData();
+    QSignalBlocker blocker(box);
+
+    uint32_t total = 0;
+    std::vector<uint32_t> sizes;
+    for (const auto& entry : counts) {
+        total += entry.second;
+        if (entry.second > 0) sizes.push_back(entry.second);
     }
-} 
\ No newline at end of file
+
+    // Smallest count that still makes the list; ties past the limit drop
+    uint32_t threshold = 1;
+    size_t tiesLeft = limit;
+    if (sizes.size() > limit && limit > 0) {
+        std::nth_element(sizes.begin(), sizes.begin() + (limit - 1), sizes.end(), std::greater<uint32_t>());
+        threshold = sizes[limit - 1];
+        tiesLeft = limit - size_t(std::count_if(sizes.begin(), sizes.end(),
+                                                [&](uint32_t n) { return n > threshold; }));
+    }
+
+    std::vector<std::pair<Key, uint32_t>> shown;
+    std::set<Key> shownKeys;
+    for (const auto& entry : counts) {
+        const bool isSelected = selected.isValid() && selected.value<Key>() == entry.first;
+        bool keep = entry.second > threshold;
+        if (!keep && entry.second == threshold && tiesLeft > 0) {
+            keep = true;
+            --tiesLeft;
+        }
+        if (!keep && !isSelected) continue;
+        shown.push_back(entry);
+        shownKeys.insert(entry.first);
+    }
+
+    auto setText = [box](int index, const QString& text) {
+        if (box->itemText(index) != text) box->setItemText(index, text);
+    };
+    if (box->count() == 0) box->addItem(QString());
+    setText(0, QString("%1 (%2)").arg(anyText).arg(total));
+
+    // Both lists are in the facet's key order, so one walk merges them: an
+    // item whose value is no longer shown goes, a value not yet at this
+    // position is new and is inserted
+    int index = 1;
+    for (const auto& entry : shown) {
+        while (index < box->count() && !shownKeys.count(box->itemData(index).value<Key>())) {
+            box->removeItem(index);
+        }
+        const QString text = QString("%1 (%2)").arg(label(entry.first)).arg(entry.second);
+        if (index < box->count() && box->itemData(index).value<Key>() == entry.first) {
+            setText(index, text);
+        } else {
+            box->insertItem(index, text, QVariant::fromValue(entry.first));
+        }
+        ++index;
+    }
+    while (box->count() > index) box->removeItem(box->count() - 1);
+
+    int current = selected.isValid() ? box->findData(selected) : 0;
+    if (box->currentIndex() != (current >= 0 ? current : 0)) {
+        box->setCurrentIndex(current >= 0 ? current : 0);
+    }
+}
+
+void MainWindow::updateFacetCounts(const DocBitmap& textMatches, const LibraryFacets::Selection& selection)
+{
+    // Each facet is counted under the other facets' selections, so its own
+    // alternatives stay visible and their counts say what picking them gives
+    auto ratingCounts = libraryFacets.ratings().counts(
+        libraryFacets.filter(textMatches, selection, LibraryFacets::RatingField));
+    std::reverse(ratingCounts.begin(), ratingCounts.end());  // Highest first
+    fillFacetBox(ratingFacetBox, "Any rating", ratingCounts, [](int rating) {
+        return rating == 0 ? QString("Unrated") : QString("%1/10").arg(rating);
+    });
+
+    fillFacetBox(decadeFacetBox, "Any decade",
+        libraryFacets.decades().counts(
+            libraryFacets.filter(textMatches, selection, LibraryFacets::DecadeField)),
+        [](int decade) {
+            return decade < 0 ? QString("Unknown") : QString("%1s").arg(decade);
+        });
+
+    fillFacetBox(artistFacetBox, "Any artist",
+        libraryFacets.artists().counts(
+            libraryFacets.filter(textMatches, selection, LibraryFacets::ArtistField)),
+        [](const QString& artist) { return artist; }, ArtistFacetLimit);
+}
+
+void MainWindow::updateLibraryCount()
+{
+    // Counted from the filter, not the rows, which may still be filling in
+    const int visible = int(libraryMatches.count());
+    libraryCountLabel->setText(visible == libraryAlbums.size()
+        ? QString("%1 albums").arg(libraryAlbums.size())
+        : QString("%1 of %2 albums").arg(visible).arg(libraryAlbums.size()));
+}
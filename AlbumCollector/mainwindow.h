@@ -12,8 +12,17 @@
 #include <QStackedWidget>
 #include <QListWidget>
 #include <QVector>
+#include <QHash>
+#include <QSet>
 #include <QBuffer>
 #include "SpotifyClient.h"
+#include "SearchCache.h"
+#include "LibraryIndex.h"
+#include "LibraryFacets.h"
+#include "LibraryStore.h"
+#include "LibraryMutation.h"
+#include "LibrarySort.h"
+#include "thumbnailsidecar.h"
 #include <QComboBox>
 #include <QDate>
 #include <QColorDialog>
@@ -21,6 +30,19 @@
 #include <unordered_set>
 #include <QTimer>
 #include <QHBoxLayout>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <atomic>
+
+class QProgressBar;
+class EventLoopMonitor;
+class LibraryGridModel;
+class LibraryGridView;
+class ThumbnailCache;
+class LibraryImporter;
+class QProgressDialog;
+class QUndoStack;
+class LibraryCommand;
 
 class RatingWidget : public QWidget {
     Q_OBJECT
@@ -29,27 +51,30 @@ public:
     void setRating(int value);
     int getRating() const { return currentRating; }
     void resetRating();
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
 
 signals:
     void ratingChanged(int newRating);
 
 protected:
-    bool eventFilter(QObject* obj, QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
 
 private:
     static const int MAX_RATING = 10;
-    QHBoxLayout* layout;
-    QLabel* ratingLabel;
-    QVector<QLabel*> recordLabels;
-    QPixmap normalRecord;
-    QPixmap grayedRecord;
+    static const int RecordSize = 20;
+
+    struct RecordPixmaps {
+        QPixmap normal;
+        QPixmap grayed;
+        qreal dpr = 0;
+    };
+    static const RecordPixmaps& recordPixmaps(qreal dpr);
+
     int currentRating;
-    QLabel* iconLabel;
-    
-    void setupRecords();
+
     void updateDisplay();
-    void showRecords();
-    void showRatingText();
 };
 
 class AlbumListItem : public QWidget {
@@ -75,13 +100,6 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
 private:
-    struct LibraryAlbum {
-        Album album;
-        QByteArray imageData;
-        LibraryAlbum(const Album& a, const QByteArray& img) 
-            : album(a), imageData(img) {}
-    };
-
     struct ThemeColors {
         QString name;
         QColor background;
@@ -95,17 +113,45 @@ private:
     };
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    // Logical sizes of the search row thumbnail and the details dialog cover
+    static constexpr int ThumbnailSize = 60;
+    static constexpr int DetailCoverSize = 300;
+
+    // libraryPath overrides the default library.dat, e.g. for scale tests
+    MainWindow(QWidget *parent = nullptr, const QString& libraryPath = QString());
     ~MainWindow();
+    // Writes library.dat now if anything changed since the last save
     void saveLibrary();
     QString formatDate(const std::string& dateStr);
     void updateAlbumRating(const std::string& albumId, int rating);
+    TransferStats& searchTransferStats() { return spotify.transferStats(); }
+    TransferStats& albumArtTransferStats() { return imageTransferStats; }
+    qint64 libraryLoadTime() const { return libraryLoadMs; }
+    int libraryAlbumCount() const { return libraryAlbums.size(); }
+    // Builds the library page if needed and switches to it
+    void showLibraryPage() { switchToLibrary(); }
+    bool isLibraryPopulated() const {
+        return libraryList && (libraryGridMode() ||
+            (libraryList->count() == libraryAlbums.size() && libraryBuildCursor == libraryList->count()));
+    }
+    // Duration of the last full row build and the longest the event loop
+    // went unserviced during it
+    double libraryPopulateTime() const { return libraryPopulateMs; }
+    double libraryPopulateMaxBlock() const { return libraryPopulateMaxBlockMs; }
+    // Applies a built-in theme without remembering it, for measurements
+    int themeCount() const { return themes.size(); }
+    void previewTheme(int index) { applyTheme(themes[index]); }
+    void restoreSavedTheme() { applySavedTheme(); }
+
+signals:
+    // Every library row has been built after a refresh
+    void libraryPopulated();
 
 protected:
     void closeEvent(QCloseEvent *event) override;
 
 public slots:
-    void addToLibrary(const Album& album, const QPixmap& albumArt);
+    void addToLibrary(const Album& album, const QPixmap& rowArt);
 
 private slots:
     void performSearch(bool loadingMore = false);
@@ -125,27 +171,93 @@ private:
     QListWidget* resultsList;
     QLabel* statusLabel;
     SpotifyClient spotify;
+    SearchCache searchCache;
     std::vector<Album> currentResults;
     QNetworkAccessManager* networkManager;
+    TransferStats imageTransferStats;
     
     // New UI elements
     QListWidget* sidebar;
     QStackedWidget* stackedWidget;
     QWidget* searchPage;
-    QWidget* libraryPage;
-    QListWidget* libraryList;
+    QWidget* libraryPage = nullptr;
+    QListWidget* libraryList = nullptr;
     QVector<LibraryAlbum> libraryAlbums;
-    QComboBox* sortComboBox;
+    LibraryStore libraryStore;
+    ThumbnailSidecar thumbnailSidecar;
+    QFutureWatcher<bool>* sidecarWatcher = nullptr;
+    int sidecarMisses = 0;  // Covers the sidecar lacked during this population
+    qint64 libraryLoadMs = 0;
+    QComboBox* sortComboBox = nullptr;
     QWidget* settingsWidget;
     QPushButton* colorThemeButton;
     QVBoxLayout* sidebarLayout;
     QHBoxLayout* mainLayout;
 
-    QWidget* settingsPage;
-    QListWidget* themeList;
+    QWidget* settingsPage = nullptr;
+    QListWidget* themeList = nullptr;
     QVector<ThemeColors> themes;
+    QHash<QString, QLabel*> diagnosticsLabels;
+    QTimer* diagnosticsTimer = nullptr;
 
     std::unordered_set<std::string> libraryAlbumIds;
+    LibraryIndex libraryIndex;
+    QLineEdit* libraryFilterBox = nullptr;
+    QLabel* libraryCountLabel = nullptr;
+    LibraryFacets libraryFacets;
+    QComboBox* ratingFacetBox = nullptr;
+    QComboBox* decadeFacetBox = nullptr;
+    QComboBox* artistFacetBox = nullptr;
+    static constexpr size_t ArtistFacetLimit = 200;  // Largest artists listed
+    DocBitmap libraryMatches;  // Albums passing the current filter
+    QTimer* libraryPopulateTimer = nullptr;
+    int libraryBuildCursor = 0;  // Every row above this has its widget
+    QSize libraryRowHint;        // Placeholder row size until the widget exists
+    QProgressBar* libraryProgress = nullptr;
+    EventLoopMonitor* populateMonitor = nullptr;
+    QElapsedTimer populateElapsed;
+    double libraryPopulateMs = 0;
+    double libraryPopulateMaxBlockMs = 0;
+    static constexpr int LibrarySliceMs = 4;
+    QComboBox* viewModeBox = nullptr;
+    QStackedWidget* libraryViews = nullptr;
+    LibraryGridView* libraryGrid = nullptr;
+    LibraryGridModel* libraryGridModel = nullptr;
+    ThumbnailCache* thumbnailCache = nullptr;
+    // Cover dHashes by album id, with the encoded size they were taken from
+    QHash<QString, QPair<qint64, quint64>> coverHashes;
+    QFutureWatcher<quint64>* coverHashWatcher = nullptr;
+    QVector<QPair<QString, qint64>> coverHashPending;  // Id and cover size per job
+    QElapsedTimer duplicateScanTimer;
+    QPushButton* duplicatesButton = nullptr;
+    // Browse by colour: covers nearest a picked colour, or like one cover
+    QColor libraryBrowseColor;
+    ColorSignature libraryColorReference;
+    int lastSortIndex = SortByArtist;
+    QFutureWatcher<ColorSignature>* colorWatcher = nullptr;
+    QVector<QString> colorPending;  // Album ids the watcher is working on
+    QSet<QString> colorlessCovers;  // Covers that would not decode
+    int coverThemeIndex = -1;       // Theme seeded from the library's covers
+    LibraryImporter* importer = nullptr;
+    // Re-fetched covers collect here and go in as one change
+    QNetworkAccessManager* coverNetwork = nullptr;
+    LibraryMutation coverRefetch;
+    int coverRefetchPending = 0;
+    // Undo history of library changes; each step holds only its inverse
+    static constexpr int UndoLimit = 100;
+    QUndoStack* undoStack = nullptr;
+    QAction* undoAction = nullptr;
+    QAction* redoAction = nullptr;
+    // Changes mark the library dirty and start the timer; bursts of them
+    // (ratings, undo, enrichment and colour batches) end in one write
+    static constexpr int LibrarySaveDelayMs = 1500;
+    QTimer* librarySaveTimer = nullptr;
+    bool libraryDirty = false;
+    void scheduleLibrarySave();
+    int libraryOrder = 0;  // Bumped by every sort, so undo knows when to sort again
+    friend class LibraryCommand;
+    QProgressDialog* importProgress = nullptr;
+    bool libraryGridMode() const { return viewModeBox && viewModeBox->currentIndex() == 1; }
 
     bool isSearching = false;
     QTimer* searchDebounceTimer;
@@ -154,17 +266,67 @@ private:
     int currentSearchOffset = 0;
     QPushButton* loadMoreButton;
     int totalResults = 0;
+    quint64 searchGeneration = 0;
+    std::unordered_set<std::string> displayedResultIds;
+    QVector<int> offlineOffsets;
+    QTimer* reconnectTimer;
 
     void setupUi();
     void setupSidebar();
     void setupSearchPage();
     void setupLibraryPage();
     void setupSettingsPage();
+    void ensureLibraryPage();
+    void ensureSettingsPage();
+    void loadThemes();
+    int savedThemeIndex() const;
+    void applySavedTheme();
+    void populateLibraryChunk();
+    void buildLibraryRow(int row);
+    int thumbnailPixels() const;
+    void rebuildThumbnailSidecar();
+    void updateDiagnostics();
     void displayResults(const std::vector<Album>& albums, bool append = false);
-    void downloadAlbumArt(const QString& url, AlbumListItem* item);
+    void fetchLiveResults(const QString& query, int offset);
+    void retryOfflineSearches();
+    QNetworkReply* downloadAlbumArt(const QString& url, AlbumListItem* item);
     void refreshLibraryDisplay();
-    void removeSelectedAlbum();
+    // Ids of the albums selected in the current view, in library order
+    std::vector<std::string> selectedLibraryAlbumIds() const;
+    void showLibraryContextMenu(const QPoint& globalPos, int clickedAlbum);
+    // Applies the change and puts it on the undo stack under text.
+    // sortAdded sorts the library once added albums are in.
+    void changeLibrary(const QString& text, const LibraryMutation& mutation, bool sortAdded = false);
+    // Returns the mutation that undoes it
+    LibraryMutation applyLibraryMutation(const LibraryMutation& mutation, bool sortAdded);
+    void updateLibraryRows(const LibraryMutation::Applied& applied);
+    void removeLibraryAlbums(const std::vector<std::string>& albumIds);
+    void rateLibraryAlbums(const std::vector<std::string>& albumIds, int rating);
+    void refetchCovers(const std::vector<std::string>& albumIds);
+    void showAlbumDialog(const Album& album);
+    void applyLibraryFilter();
+    void updateLibraryCount();
+    LibraryFacets::Selection currentFacetSelection() const;
+    void updateFacetCounts(const DocBitmap& textMatches, const LibraryFacets::Selection& selection);
     void checkScrollPosition();
+    void findDuplicates();
+    void importAlbums();
+    void commitImport(const QVector<LibraryAlbum>& albums, int unresolved, int failed, bool cancelled);
+    void pickBrowseColor();
+    void showSimilarCovers(const std::string& albumId);
+    int libraryRowOf(const std::string& albumId) const;  // -1 when not in the library
+    void computeColorSignatures();
+    void updateCoverTheme();
+    static ThemeColors themeFromSeed(const QString& name, const QColor& seed);
+    static QPixmap themePreview(const ThemeColors& theme);
+    void showDuplicates();
+
+    // Background metadata enrichment through the several-albums endpoint
+    QFutureWatcher<void>* enrichmentWatcher;
+    std::atomic<bool> stopEnrichment{false};
+    bool enrichmentPending = false;
+    void enrichLibrary();
+    void applyAlbumDetails(const std::vector<std::string>& requested, const std::vector<Album>& albums);
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
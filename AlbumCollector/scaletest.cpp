@@ -0,0 +1,138 @@
+#include "scaletest.h"
+#include "mainwindow.h"
+#include <QComboBox>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QListWidget>
+#include <QScrollBar>
+#include <QTimer>
+
+ScaleTest::ScaleTest(MainWindow* window, const QElapsedTimer& sinceStart,
+                     const QString& reportPath, QObject* parent)
+    : QObject(parent), window(window), sinceStart(sinceStart), reportPath(reportPath)
+{
+}
+
+void ScaleTest::start()
+{
+    // Watch the whole application: whichever widget of the window paints
+    // first marks the first frame
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+bool ScaleTest::eventFilter(QObject* obj, QEvent* event)
+{
+    if (!painted && event->type() == QEvent::Paint && obj->isWidgetType() &&
+        static_cast<QWidget*>(obj)->window() == window) {
+        painted = true;
+        record("firstPaint", sinceStart.elapsed());
+        QCoreApplication::instance()->removeEventFilter(this);
+
+        // Let the first frame reach the screen before measuring anything else
+        QTimer::singleShot(0, this, &ScaleTest::run);
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void ScaleTest::record(const QString& name, double ms)
+{
+    results.insert(name, ms);
+    qInfo().noquote() << QString("scale-test: %1 = %2 ms").arg(name).arg(ms, 0, 'f', 1);
+}
+
+void ScaleTest::run()
+{
+    results.insert("albums", window->libraryAlbumCount());
+    record("libraryLoad", window->libraryLoadTime());
+
+    // The library page is built on first visit, so this includes building it
+    QElapsedTimer timer;
+    timer.start();
+    window->showLibraryPage();
+    QCoreApplication::processEvents();
+    record("showLibrary", timer.nsecsElapsed() / 1e6);
+    waitForPopulation();
+    record("populateLibrary", timer.nsecsElapsed() / 1e6);
+    record("populateLibrary/maxBlock", window->libraryPopulateMaxBlock());
+
+    QListWidget* libraryList = window->findChild<QListWidget*>("libraryList");
+    QComboBox* sortBox = window->findChild<QComboBox*>("sortComboBox");
+    if (!libraryList || !sortBox) {
+        qWarning() << "scale-test: library page not found";
+        finish();
+        return;
+    }
+
+    // Start away from the current mode so every switch really re-sorts.
+    // Rows are rebuilt in chunks, so a sort counts until the last one lands.
+    for (int mode : {1, 2, 3, 0}) {
+        timer.restart();
+        sortBox->setCurrentIndex(mode);
+        QCoreApplication::processEvents();
+        waitForPopulation();
+        record("sort/" + sortBox->itemText(mode), timer.nsecsElapsed() / 1e6);
+        record("sort/" + sortBox->itemText(mode) + "/maxBlock", window->libraryPopulateMaxBlock());
+    }
+
+    // Page through the whole list, painting every step like a user would
+    QScrollBar* bar = libraryList->verticalScrollBar();
+    bar->setValue(0);
+    double worstStep = 0;
+    int steps = 0;
+    timer.restart();
+    QElapsedTimer stepTimer;
+    while (bar->value() < bar->maximum()) {
+        stepTimer.start();
+        bar->setValue(bar->value() + bar->pageStep());
+        libraryList->viewport()->repaint();
+        worstStep = qMax(worstStep, stepTimer.nsecsElapsed() / 1e6);
+        ++steps;
+    }
+    record("scrollTotal", timer.nsecsElapsed() / 1e6);
+    record("scrollWorstStep", worstStep);
+    results.insert("scrollSteps", steps);
+
+    // Theme switches with every library row alive: palette change plus a
+    // synchronous repaint of the whole window
+    const int switches = qMin(window->themeCount(), 6);
+    double totalSwitch = 0;
+    double worstSwitch = 0;
+    for (int i = 0; i < switches; ++i) {
+        timer.restart();
+        window->previewTheme(i);
+        QCoreApplication::processEvents();
+        window->repaint();
+        const double ms = timer.nsecsElapsed() / 1e6;
+        totalSwitch += ms;
+        worstSwitch = qMax(worstSwitch, ms);
+    }
+    window->restoreSavedTheme();
+    if (switches > 0) {
+        record("themeSwitch/mean", totalSwitch / switches);
+        record("themeSwitch/worst", worstSwitch);
+    }
+
+    finish();
+}
+
+void ScaleTest::waitForPopulation()
+{
+    if (window->isLibraryPopulated()) return;
+    QEventLoop loop;
+    connect(window, &MainWindow::libraryPopulated, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+void ScaleTest::finish()
+{
+    if (!reportPath.isEmpty()) {
+        QFile file(reportPath);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(results).toJson());
+        }
+    }
+    QCoreApplication::quit();
+}
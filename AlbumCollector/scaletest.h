@@ -0,0 +1,42 @@
+#ifndef SCALETEST_H
+#define SCALETEST_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+
+class MainWindow;
+
+// Drives a started MainWindow through the operations that scale with
+// library size (load, first paint, building the rows, every sort mode,
+// scrolling the whole list, switching themes), prints the timings and
+// quits. Enabled by --scale-test; the theme-switch figure usually quoted
+// is from a 5000 album library:
+//   ./libgen --albums 5000 lib5k.dat
+//   ./AlbumCollector --scale-test lib5k.dat --scale-report lib5k.json
+class ScaleTest : public QObject {
+    Q_OBJECT
+public:
+    ScaleTest(MainWindow* window, const QElapsedTimer& sinceStart,
+              const QString& reportPath, QObject* parent = nullptr);
+
+    // Waits for the window's first paint, then runs
+    void start();
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event) override;
+
+private:
+    MainWindow* window;
+    QElapsedTimer sinceStart;
+    QString reportPath;
+    QJsonObject results;
+    bool painted = false;
+
+    void run();
+    void record(const QString& name, double ms);
+    void waitForPopulation();
+    void finish();
+};
+
+#endif // SCALETEST_H
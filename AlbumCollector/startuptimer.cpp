@@ -0,0 +1,47 @@
+#include "startuptimer.h"
+#include "Metrics.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+
+StartupTimer::StartupTimer(const QElapsedTimer& sinceStart, QObject* parent)
+    : QObject(parent), sinceStart(sinceStart)
+{
+}
+
+void StartupTimer::mark(const QString& phase)
+{
+    phases << QString("%1 %2 ms").arg(phase).arg(sinceStart.elapsed());
+}
+
+void StartupTimer::watch(QWidget* window)
+{
+    this->window = window;
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+bool StartupTimer::eventFilter(QObject* obj, QEvent* event)
+{
+    if (window && event->type() == QEvent::Paint && obj->isWidgetType() &&
+        static_cast<QWidget*>(obj)->window() == window) {
+        window = nullptr;
+        QCoreApplication::instance()->removeEventFilter(this);
+        Metrics::gauge("startup.firstPaintMs").set(sinceStart.elapsed());
+        mark("firstPaint");
+
+        // A zero timer fires once everything already queued has run
+        QTimer::singleShot(0, this, [this]() {
+            Metrics::gauge("startup.interactiveMs").set(sinceStart.elapsed());
+            mark("interactive");
+            report();
+        });
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void StartupTimer::report()
+{
+    qInfo().noquote() << "startup:" << phases.join(", ");
+}
@@ -0,0 +1,34 @@
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+
+class QWidget;
+
+// Logs how long startup takes, phase by phase, ending with the window's
+// first paint and the first idle event-loop turn after it ("interactive").
+// Always on: it costs one event filter until the first frame.
+class StartupTimer : public QObject {
+    Q_OBJECT
+public:
+    explicit StartupTimer(const QElapsedTimer& sinceStart, QObject* parent = nullptr);
+
+    // Records a named phase boundary, in ms since process start
+    void mark(const QString& phase);
+    // Watches window for its first paint, then reports
+    void watch(QWidget* window);
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event) override;
+
+private:
+    QElapsedTimer sinceStart;
+    QWidget* window = nullptr;
+    QStringList phases;
+
+    void report();
+};
+
+#endif // STARTUPTIMER_H
@@ -0,0 +1,169 @@
+#include "themestyle.h"
+#include <QAbstractButton>
+#include <QPainter>
+#include <QStyleFactory>
+#include <QStyleOptionButton>
+
+namespace {
+
+const QColor DisabledButton("#CCCCCC");
+const QColor DisabledButtonText("#666666");
+const int CornerRadius = 4;
+
+bool isAddedButton(const QWidget* widget)
+{
+    return widget && widget->property("isAdded").toBool();
+}
+
+} // namespace
+
+// Fusion honours every palette role on all platforms, unlike the native
+// macOS style, so it is the base the palette is drawn onto
+ThemeStyle::ThemeStyle()
+    : QProxyStyle(QStyleFactory::create("Fusion"))
+{
+}
+
+QPalette ThemeStyle::makePalette(const QColor& background, const QColor& sidebar,
+                                 const QColor& text, const QColor& accent)
+{
+    QPalette palette;
+    palette.setColor(QPalette::Window, background);
+    palette.setColor(QPalette::Base, background);
+    palette.setColor(QPalette::AlternateBase, background.lightness() > 128
+                                                  ? background.darker(105)
+                                                  : background.lighter(115));
+    palette.setColor(QPalette::WindowText, text);
+    palette.setColor(QPalette::Text, text);
+    palette.setColor(QPalette::ButtonText, text);
+    palette.setColor(QPalette::Button, sidebar);
+    palette.setColor(QPalette::Highlight, accent);
+    palette.setColor(QPalette::HighlightedText, Qt::white);
+    palette.setColor(QPalette::Link, accent);
+    palette.setColor(QPalette::ToolTipBase, sidebar);
+    palette.setColor(QPalette::ToolTipText, text);
+
+    QColor placeholder = text;
+    placeholder.setAlpha(128);
+    palette.setColor(QPalette::PlaceholderText, placeholder);
+    palette.setColor(QPalette::Disabled, QPalette::Text, placeholder);
+    palette.setColor(QPalette::Disabled, QPalette::WindowText, placeholder);
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, DisabledButtonText);
+    palette.setColor(QPalette::Disabled, QPalette::Button, DisabledButton);
+    return palette;
+}
+
+QPalette ThemeStyle::makeSidebarPalette(const QColor& sidebar, const QColor& text,
+                                        const QColor& accent)
+{
+    QPalette palette = makePalette(sidebar, sidebar, text, accent);
+    palette.setColor(QPalette::Mid, sidebar.darker(120));  // Dividers and hover
+    return palette;
+}
+
+void ThemeStyle::polish(QWidget* widget)
+{
+    QProxyStyle::polish(widget);
+    // Hover colours need hover events
+    if (qobject_cast<QAbstractButton*>(widget)) {
+        widget->setAttribute(Qt::WA_Hover);
+    }
+}
+
+void ThemeStyle::drawPrimitive(PrimitiveElement element, const QStyleOption* option,
+                               QPainter* painter, const QWidget* widget) const
+{
+    switch (element) {
+    case PE_PanelButtonCommand: {
+        QColor fill = option->palette.color(QPalette::Active, QPalette::Button);
+        if (isAddedButton(widget)) {
+            fill = option->palette.color(QPalette::Active, QPalette::Highlight);
+        } else if (!(option->state & State_Enabled)) {
+            fill = DisabledButton;
+        } else if (option->state & (State_MouseOver | State_Sunken)) {
+            fill = option->palette.color(QPalette::Active, QPalette::Highlight);
+        }
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(fill);
+        painter->drawRoundedRect(QRectF(option->rect), CornerRadius, CornerRadius);
+        painter->restore();
+        return;
+    }
+    case PE_FrameLineEdit: {
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(option->palette.color(QPalette::Active, QPalette::Highlight),
+                             (option->state & State_HasFocus) ? 2 : 1));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawRoundedRect(QRectF(option->rect).adjusted(0.5, 0.5, -0.5, -0.5),
+                                 CornerRadius, CornerRadius);
+        painter->restore();
+        return;
+    }
+    case PE_FrameFocusRect:
+        // The accent frame and hover fill already show focus
+        if (qobject_cast<const QAbstractButton*>(widget)) return;
+        break;
+    default:
+        break;
+    }
+    QProxyStyle::drawPrimitive(element, option, painter, widget);
+}
+
+void ThemeStyle::drawControl(ControlElement element, const QStyleOption* option,
+                             QPainter* painter, const QWidget* widget) const
+{
+    if (element == CE_PushButtonLabel) {
+        // White on the accent fill, as the old stylesheet had it
+        if (const auto* button = qstyleoption_cast<const QStyleOptionButton*>(option)) {
+            const bool onAccent = isAddedButton(widget) ||
+                ((button->state & State_Enabled) && (button->state & (State_MouseOver | State_Sunken)));
+            if (onAccent) {
+                QStyleOptionButton copy(*button);
+                copy.palette.setColor(QPalette::ButtonText, Qt::white);
+                copy.state |= State_Enabled;  // "Added" is disabled but not greyed
+                QProxyStyle::drawControl(element, &copy, painter, widget);
+                return;
+            }
+        }
+    }
+    QProxyStyle::drawControl(element, option, painter, widget);
+}
+
+void SidebarItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                                const QModelIndex& index) const
+{
+    const QPalette& palette = option.palette;
+    QColor background = palette.color(QPalette::Base);
+    QColor foreground = palette.color(QPalette::Text);
+    const QColor divider = palette.color(QPalette::Mid);
+
+    if (option.state & QStyle::State_Selected) {
+        background = palette.color(QPalette::Highlight);
+        foreground = palette.color(QPalette::HighlightedText);
+    } else if (option.state & QStyle::State_MouseOver) {
+        background = divider;
+        foreground = palette.color(QPalette::HighlightedText);
+    }
+
+    painter->save();
+    painter->fillRect(option.rect, background);
+    if (!(option.state & QStyle::State_Selected)) {
+        painter->setPen(divider);
+        painter->drawLine(option.rect.bottomLeft(), option.rect.bottomRight());
+    }
+    painter->setPen(foreground);
+    painter->setFont(option.font);
+    painter->drawText(option.rect.adjusted(15, 0, -15, 0), Qt::AlignLeft | Qt::AlignVCenter,
+                      index.data(Qt::DisplayRole).toString());
+    painter->restore();
+}
+
+QSize SidebarItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const QFontMetrics metrics(option.font);
+    return QSize(metrics.horizontalAdvance(index.data(Qt::DisplayRole).toString()) + 30,
+                 metrics.height() + 24);
+}
@@ -0,0 +1,156 @@
+#include "thumbnailcache.h"
+#include <QBuffer>
+#include <QImageReader>
+#include <iterator>
+#include "Trace.h"
+
+const int ThumbnailCache::Levels[] = {64, 128, 256, 512};
+
+namespace {
+
+// Enough for a few screens of the largest cells before the first setWanted
+const qint64 InitialBudgetBytes = 32 * 1024 * 1024;
+
+QImage decodeScaled(const QByteArray& encoded, int level)
+{
+    QBuffer buffer;
+    buffer.setData(encoded);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    const QSize size = reader.size();
+    if (size.isValid() && (size.width() > level || size.height() > level)) {
+        // JPEG decoders scale during decode, skipping most of the work
+        reader.setScaledSize(size.scaled(level, level, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) return image;
+    if (image.width() > level || image.height() > level) {
+        image = image.scaled(level, level, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+} // namespace
+
+ThumbnailCache::ThumbnailCache(QObject* parent)
+    : QObject(parent)
+{
+    images.setMaxCost(InitialBudgetBytes);
+    pool.setMaxThreadCount(2);
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    for (const auto& job : pending) job->cancelled = true;
+    pool.clear();
+    pool.waitForDone();
+}
+
+int ThumbnailCache::levelFor(int devicePixels)
+{
+    for (int level : Levels) {
+        if (level >= devicePixels) return level;
+    }
+    return Levels[std::size(Levels) - 1];
+}
+
+QImage ThumbnailCache::lookup(const QString& key, int devicePixels, const QByteArray& encoded)
+{
+    const int level = levelFor(devicePixels);
+    if (QImage* image = images.object({key, level})) return *image;
+
+    if (!pending.contains({key, level}) && !encoded.isEmpty() && !undecodable.contains(key)) {
+        queueDecode({key, level}, encoded);
+    }
+
+    // Stand-in until the right level lands: prefer a larger level, which
+    // scales down cleanly, over a blurry smaller one
+    QImage fallback;
+    for (int other : Levels) {
+        if (other == level) continue;
+        if (QImage* image = images.object({key, other})) {
+            fallback = *image;
+            if (other > level) break;
+        }
+    }
+    return fallback;
+}
+
+void ThumbnailCache::setWanted(const QVector<Request>& wanted, int devicePixels)
+{
+    const int level = levelFor(devicePixels);
+    QSet<QString> keys;
+    keys.reserve(wanted.size());
+    for (const Request& request : wanted) keys.insert(request.key);
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (!keys.contains(it.key().first)) {
+            it.value()->cancelled = true;
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const qint64 perImage = qint64(level) * level * 4;
+    images.setMaxCost(qMax<qint64>(2 * keys.size() * perImage, 4 * perImage));
+
+    // Queue in the order given, which views make nearest-first
+    for (const Request& request : wanted) {
+        const Key key(request.key, level);
+        if (!images.contains(key) && !pending.contains(key) &&
+            !request.encoded.isEmpty() && !undecodable.contains(request.key)) {
+            queueDecode(key, request.encoded);
+        }
+    }
+}
+
+void ThumbnailCache::remove(const QString& key)
+{
+    for (int level : Levels) {
+        images.remove({key, level});
+        auto job = pending.find({key, level});
+        if (job != pending.end()) {
+            (*job)->cancelled = true;
+            pending.erase(job);
+        }
+    }
+    undecodable.remove(key);
+}
+
+void ThumbnailCache::clear()
+{
+    for (const auto& job : pending) job->cancelled = true;
+    pending.clear();
+    images.clear();
+    undecodable.clear();
+}
+
+void ThumbnailCache::queueDecode(const Key& key, const QByteArray& encoded)
+{
+    auto job = std::make_shared<Job>();
+    pending.insert(key, job);
+
+    // The destructor waits for the pool, so this outlives every job; a
+    // result posted after destruction is discarded with the object's events
+    pool.start([this, job, key, encoded]() {
+        if (job->cancelled) return;
+        TRACE_SPAN("decodeThumbnail", "image");
+        QImage image = decodeScaled(encoded, key.second);
+        if (job->cancelled) return;
+        QMetaObject::invokeMethod(this, [this, job, key, image]() {
+            if (!job->cancelled) store(key, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ThumbnailCache::store(const Key& key, const QImage& image)
+{
+    pending.remove(key);
+    if (image.isNull()) {
+        undecodable.insert(key.first);
+        return;
+    }
+    images.insert(key, new QImage(image), image.sizeInBytes());
+    emit thumbnailReady(key.first);
+}
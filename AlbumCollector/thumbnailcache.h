@@ -0,0 +1,68 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+// Decoded covers at a few fixed sizes (levels), keyed by album id. Decoding
+// runs on a small private pool, downscaling inside the decoder so large
+// covers never exist at full size in memory. Views say which keys they want
+// (visible cells plus a prefetch margin); queued decodes for anything else
+// are cancelled and the byte budget follows the wanted set, so memory is
+// bounded by what is on or near the screen.
+class ThumbnailCache : public QObject {
+    Q_OBJECT
+public:
+    explicit ThumbnailCache(QObject* parent = nullptr);
+    ~ThumbnailCache();
+
+    // Smallest level >= devicePixels (capped at the largest level)
+    static int levelFor(int devicePixels);
+
+    // Image at the level for devicePixels if decoded; otherwise the closest
+    // other level as a stand-in (possibly null) and a decode is queued.
+    // encoded is only read if a decode is needed.
+    QImage lookup(const QString& key, int devicePixels, const QByteArray& encoded);
+
+    struct Request {
+        QString key;
+        QByteArray encoded;
+    };
+
+    // What the view needs at this size: visible cells plus its prefetch
+    // margin. Missing ones are queued, queued decodes for anything else are
+    // dropped, and the memory budget becomes room for this set twice over.
+    void setWanted(const QVector<Request>& wanted, int devicePixels);
+
+    // Drops every level for key, e.g. once its cover has been replaced
+    void remove(const QString& key);
+    void clear();
+
+signals:
+    void thumbnailReady(const QString& key);
+
+private:
+    using Key = QPair<QString, int>;
+    struct Job {
+        std::atomic<bool> cancelled{false};
+    };
+
+    static const int Levels[];
+
+    QCache<Key, QImage> images;
+    QHash<Key, std::shared_ptr<Job>> pending;
+    QSet<QString> undecodable;
+    QThreadPool pool;
+
+    void queueDecode(const Key& key, const QByteArray& encoded);
+    void store(const Key& key, const QImage& image);
+};
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,304 @@
+#include "thumbnailsidecar.h"
+#include <QBuffer>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include "Trace.h"
+
+namespace {
+
+const quint32 SidecarMagic = 0x41435448;
+const quint32 SidecarVersion = 3;  // Version 3 keys on cover hashes and stores RGB888
+
+struct Header {
+    quint32 magic;
+    quint32 version;
+    quint32 pixels;
+    quint32 count;     // Entries in use; slots past it are free
+    quint32 capacity;  // Entries the table has room for
+    quint32 reserved;
+};
+static_assert(sizeof(Header) % 8 == 0, "the entry table stays 8-byte aligned");
+
+struct RawEntry {
+    char id[32];
+    quint64 coverKey;
+    qint32 width;
+    qint32 height;
+};
+static_assert(sizeof(RawEntry) == 48, "sidecar entries are fixed-size");
+
+QByteArray idOf(const RawEntry& entry)
+{
+    return QByteArray(entry.id, int(strnlen(entry.id, sizeof(entry.id))));
+}
+
+// Pixel slots start on a cache line so every scanline is aligned
+qint64 dataOffsetFor(quint32 count)
+{
+    const qint64 table = qint64(sizeof(Header)) + qint64(count) * sizeof(RawEntry);
+    return (table + 63) & ~qint64(63);
+}
+
+// Scanlines are padded to 4 bytes, as QImage wants them
+qint64 lineBytes(int pixels)
+{
+    return (qint64(pixels) * 3 + 3) & ~qint64(3);
+}
+
+qint64 slotBytes(int pixels)
+{
+    return lineBytes(pixels) * pixels;
+}
+
+// Half again as many entries, so a growing library appends many times
+// between full rewrites, which also drop replaced covers' slots
+quint32 capacityFor(int count)
+{
+    return quint32(count + std::max(count / 2, 64));
+}
+
+// Header and entries in use of an existing file for these pixels; false
+// when it is missing, not a sidecar, for another size or cut short
+bool readTable(QFile& file, int pixels, Header& header, QVector<RawEntry>& table)
+{
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))) return false;
+    if (header.magic != SidecarMagic || header.version != SidecarVersion ||
+        int(header.pixels) != pixels || header.count > header.capacity ||
+        file.size() < dataOffsetFor(header.capacity) + header.count * slotBytes(pixels)) {
+        return false;
+    }
+    table.resize(int(header.count));
+    const qint64 bytes = qint64(header.count) * sizeof(RawEntry);
+    return file.read(reinterpret_cast<char*>(table.data()), bytes) == bytes;
+}
+
+// Decodes one cover into slot and returns its table entry
+RawEntry renderSlot(const ThumbnailSidecar::Entry& entry, int pixels, QByteArray& slot)
+{
+    RawEntry raw;
+    std::memset(&raw, 0, sizeof(raw));
+    raw.coverKey = ThumbnailSidecar::coverKey(entry.encoded);
+    slot.fill('\0');
+
+    QImage image;
+    if (entry.id.size() < sizeof(raw.id)) {
+        std::memcpy(raw.id, entry.id.data(), entry.id.size());
+        QBuffer buffer;
+        buffer.setData(entry.encoded);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        const QSize size = reader.size();
+        if (size.isValid() && (size.width() > pixels || size.height() > pixels)) {
+            reader.setScaledSize(size.scaled(pixels, pixels, Qt::KeepAspectRatio));
+        }
+        image = reader.read();
+    }
+    if (!image.isNull()) {
+        if (image.width() > pixels || image.height() > pixels) {
+            image = image.scaled(pixels, pixels, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        // Covers are opaque; the odd transparent one is flattened onto white
+        if (image.hasAlphaChannel()) {
+            QImage opaque(image.size(), QImage::Format_RGB888);
+            opaque.fill(Qt::white);
+            QPainter(&opaque).drawImage(0, 0, image);
+            image = opaque;
+        } else {
+            image = image.convertToFormat(QImage::Format_RGB888);
+        }
+        for (int y = 0; y < image.height(); ++y) {
+            std::memcpy(slot.data() + y * lineBytes(pixels), image.constScanLine(y), image.width() * 3);
+        }
+        raw.width = image.width();
+        raw.height = image.height();
+    }
+    return raw;
+}
+
+} // namespace
+
+ThumbnailSidecar::ThumbnailSidecar(const QString& filePath)
+    : filePath(filePath)
+{
+}
+
+QString ThumbnailSidecar::pathFor(const QString& libraryPath)
+{
+    QFileInfo info(libraryPath);
+    return info.path() + "/" + info.completeBaseName() + ".thumbs";
+}
+
+quint64 ThumbnailSidecar::coverKey(const QByteArray& encoded)
+{
+    // Seeded explicitly so the key is the same in every run. A Qt with a
+    // different hash only turns the stored keys into misses.
+    return quint64(qHash(encoded, size_t(SidecarMagic)));
+}
+
+bool ThumbnailSidecar::open(int pixels)
+{
+    TRACE_SPAN("openThumbnailSidecar", "storage");
+    close();
+    pixels = std::min(pixels, MaxPixels);
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file.size();
+    const uchar* mapped = size >= qint64(sizeof(Header)) ? file.map(0, size) : nullptr;
+    if (!mapped) {
+        file.close();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, mapped, sizeof(header));
+    const qint64 offset = dataOffsetFor(header.capacity);
+    if (header.magic != SidecarMagic || header.version != SidecarVersion ||
+        int(header.pixels) != pixels || header.count > header.capacity ||
+        size < offset + header.count * slotBytes(pixels)) {
+        file.close();
+        return false;
+    }
+
+    // Appended entries come later, so a replaced cover's newest slot wins
+    const RawEntry* entries = reinterpret_cast<const RawEntry*>(mapped + sizeof(Header));
+    index.reserve(header.count);
+    for (quint32 i = 0; i < header.count; ++i) {
+        const RawEntry& entry = entries[i];
+        if (entry.id[0] == '\0') continue;
+        index.insert(idOf(entry), {int(i), entry.coverKey, entry.width, entry.height});
+    }
+
+    base = mapped;
+    dataOffset = offset;
+    slotPixels = pixels;
+    return true;
+}
+
+void ThumbnailSidecar::close()
+{
+    index.clear();
+    base = nullptr;
+    if (file.isOpen()) file.close();  // Unmaps as well
+}
+
+bool ThumbnailSidecar::contains(const std::string& id, quint64 coverKey) const
+{
+    auto it = index.constFind(QByteArray::fromRawData(id.data(), int(id.size())));
+    return it != index.constEnd() && it->coverKey == coverKey;
+}
+
+QImage ThumbnailSidecar::image(const std::string& id, quint64 coverKey) const
+{
+    if (!base) return QImage();
+    auto it = index.constFind(QByteArray::fromRawData(id.data(), int(id.size())));
+    if (it == index.constEnd() || it->coverKey != coverKey || it->width <= 0) return QImage();
+
+    // The const constructor keeps the image read-only: nothing writes to
+    // the mapping, and anything that would gets its own copy
+    const uchar* pixels = base + dataOffset + it->position * slotBytes(slotPixels);
+    return QImage(pixels, it->width, it->height, lineBytes(slotPixels), QImage::Format_RGB888);
+}
+
+bool ThumbnailSidecar::write(const QString& filePath, int pixels, const QVector<Entry>& entries)
+{
+    TRACE_SPAN("writeThumbnailSidecar", "storage");
+    pixels = std::min(pixels, MaxPixels);
+
+    // The file being replaced, for thumbnails that only need copying. The
+    // newest slot per id is the one that counts.
+    QFile old(filePath);
+    Header oldHeader;
+    QVector<RawEntry> oldTable;
+    QHash<QByteArray, int> oldSlots;
+    if (old.open(QIODevice::ReadOnly) && readTable(old, pixels, oldHeader, oldTable)) {
+        oldSlots.reserve(oldTable.size());
+        for (int i = 0; i < oldTable.size(); ++i) {
+            if (oldTable[i].id[0] != '\0') oldSlots.insert(idOf(oldTable[i]), i);
+        }
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    // Table first with a placeholder, then one slot at a time so only a
+    // single thumbnail is ever in memory, then the real table
+    const quint32 capacity = capacityFor(entries.size());
+    Header header = {SidecarMagic, SidecarVersion, quint32(pixels), quint32(entries.size()), capacity, 0};
+    QVector<RawEntry> table(capacity);
+    std::memset(table.data(), 0, table.size() * sizeof(RawEntry));
+    const qint64 tableEnd = qint64(sizeof(Header)) + qint64(table.size()) * sizeof(RawEntry);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.constData()), table.size() * sizeof(RawEntry));
+    file.write(QByteArray(dataOffsetFor(capacity) - tableEnd, '\0'));
+
+    QByteArray slot(slotBytes(pixels), '\0');
+    for (int i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        auto it = oldSlots.constFind(QByteArray::fromRawData(entry.id.data(), int(entry.id.size())));
+        if (it != oldSlots.constEnd() && oldTable[*it].coverKey == coverKey(entry.encoded) &&
+            old.seek(dataOffsetFor(oldHeader.capacity) + *it * slot.size()) &&
+            old.read(slot.data(), slot.size()) == slot.size()) {
+            table[i] = oldTable[*it];
+        } else {
+            table[i] = renderSlot(entry, pixels, slot);
+        }
+        file.write(slot);
+    }
+
+    file.seek(sizeof(Header));
+    file.write(reinterpret_cast<const char*>(table.constData()), entries.size() * sizeof(RawEntry));
+    old.close();
+    return file.commit();
+}
+
+bool ThumbnailSidecar::append(const QString& filePath, int pixels, const QVector<Entry>& entries)
+{
+    TRACE_SPAN("appendThumbnailSidecar", "storage");
+    pixels = std::min(pixels, MaxPixels);
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadWrite)) return false;
+
+    Header header;
+    QVector<RawEntry> known;
+    if (!readTable(file, pixels, header, known)) return false;
+
+    // Covers whose newest entry has another key, or none
+    QHash<QByteArray, quint64> keys;
+    keys.reserve(known.size());
+    for (const RawEntry& entry : known) keys.insert(idOf(entry), entry.coverKey);
+    QVector<int> added;
+    for (int i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        if (entry.encoded.isEmpty()) continue;
+        auto it = keys.constFind(QByteArray::fromRawData(entry.id.data(), int(entry.id.size())));
+        if (it == keys.constEnd() || *it != coverKey(entry.encoded)) added.append(i);
+    }
+    if (added.isEmpty()) return true;
+    if (qint64(header.count) + added.size() > qint64(header.capacity)) return false;
+
+    // Slots first, then their entries, then the count: until the count is
+    // written the new data lies past it and is ignored, so an interrupted
+    // append leaves the file as it was
+    QVector<RawEntry> table(added.size());
+    QByteArray slot(slotBytes(pixels), '\0');
+    if (!file.seek(dataOffsetFor(header.capacity) + qint64(header.count) * slotBytes(pixels))) return false;
+    for (int i = 0; i < added.size(); ++i) {
+        table[i] = renderSlot(entries[added[i]], pixels, slot);
+        if (file.write(slot) != slot.size()) return false;
+    }
+
+    if (!file.seek(qint64(sizeof(Header)) + qint64(header.count) * sizeof(RawEntry))) return false;
+    const qint64 tableBytes = qint64(table.size()) * sizeof(RawEntry);
+    if (file.write(reinterpret_cast<const char*>(table.constData()), tableBytes) != tableBytes) return false;
+    if (!file.flush()) return false;
+
+    header.count += quint32(added.size());
+    if (!file.seek(0)) return false;
+    if (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != qint64(sizeof(header))) return false;
+    return file.flush();
+}
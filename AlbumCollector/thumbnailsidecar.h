@@ -0,0 +1,82 @@
+#ifndef THUMBNAILSIDECAR_H
+#define THUMBNAILSIDECAR_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+// Pre-decoded library thumbnails kept next to library.dat. Every cover is
+// stored once as RGB888 in a fixed-size slot of at most MaxPixels square,
+// so the file is memory-mapped and each thumbnail is a QImage over the
+// mapping: showing one needs no decoding and no copy. Entries are keyed on
+// the album id and a hash of the encoded cover, so a replaced cover reads
+// as a miss until its thumbnail is appended; the table keeps spare
+// capacity so new covers do not mean rewriting every slot.
+class ThumbnailSidecar {
+public:
+    // Larger displays scale the stored thumbnail up a little: about 19 KB
+    // per album instead of 57 KB for 2x ARGB
+    static constexpr int MaxPixels = 80;
+
+    explicit ThumbnailSidecar(const QString& filePath);
+
+    // library.thumbs beside the given library file
+    static QString pathFor(const QString& libraryPath);
+
+    // What entries are looked up by, from the encoded cover's bytes
+    static quint64 coverKey(const QByteArray& encoded);
+
+    // Maps the file if it holds thumbnails for this many device pixels.
+    // Any previous mapping goes away, so no image from it may still be in use.
+    bool open(int pixels);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // Edge of the stored thumbnails, pixels capped at MaxPixels
+    int pixels() const { return slotPixels; }
+
+    // Whether the file has seen this cover, including ones that would not
+    // decode and so have no image
+    bool contains(const std::string& id, quint64 coverKey) const;
+
+    // Read-only view of the stored thumbnail, or a null image on a miss.
+    // Valid until the sidecar is closed or reopened.
+    QImage image(const std::string& id, quint64 coverKey) const;
+
+    struct Entry {
+        std::string id;
+        QByteArray encoded;
+    };
+
+    // Writes the file afresh and atomically with exactly these covers.
+    // Thumbnails the old file already holds are copied over; only the rest
+    // are decoded. Slow; meant for a worker thread.
+    static bool write(const QString& filePath, int pixels, const QVector<Entry>& entries);
+
+    // Adds thumbnails for the covers the file lacks, replacing any older
+    // entry for the same id. Decoding follows the number of new covers, not
+    // the library. False when the file is missing, is for another size or
+    // has no room left in its table; write() then starts it afresh. Safe
+    // while the file is mapped: mapped slots are never touched.
+    static bool append(const QString& filePath, int pixels, const QVector<Entry>& entries);
+
+private:
+    struct Slot {
+        int position;
+        quint64 coverKey;
+        int width;
+        int height;
+    };
+
+    QString filePath;
+    QFile file;
+    const uchar* base = nullptr;
+    qint64 dataOffset = 0;
+    int slotPixels = 0;
+    QHash<QByteArray, Slot> index;
+};
+
+#endif // THUMBNAILSIDECAR_H
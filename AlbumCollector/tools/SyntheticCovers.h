@@ -0,0 +1,40 @@
+#ifndef SYNTHETICCOVERS_H
+#define SYNTHETICCOVERS_H
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QColor>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+
+// Deterministic fake cover art for benchmarks and generated libraries:
+// gradient plus blocks, so codecs see real structure rather than a flat
+// colour that compresses to nothing. Needs QtGui, hence not part of core.
+
+inline QImage makeCoverImage(int size, int seed)
+{
+    QImage image(size, size, QImage::Format_RGB32);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, size, size);
+    gradient.setColorAt(0, QColor::fromHsv((seed * 37) % 360, 180, 220));
+    gradient.setColorAt(1, QColor::fromHsv((seed * 91) % 360, 200, 80));
+    painter.fillRect(image.rect(), gradient);
+    for (int i = 0; i < 6; ++i) {
+        int block = size / 4;
+        painter.fillRect((seed * 13 + i * 29) % (size - block), (seed * 7 + i * 41) % (size - block),
+                         block, block, QColor::fromHsv((seed * 53 + i * 60) % 360, 160, 200));
+    }
+    return image;
+}
+
+inline QByteArray encodeImage(const QImage& image, const char* format, int quality = -1)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format, quality);
+    return data;
+}
+
+#endif // SYNTHETICCOVERS_H
@@ -0,0 +1,15 @@
+# Streams a library.dat out as JSON Lines, CSV or a static HTML gallery:
+#   ./libexport library.dat albums.jsonl
+#   ./libexport --format html library.dat gallery/
+
+QT       += core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = libexport
+
+SOURCES += \
+    main.cpp
+
+include(../../core/core.pri)
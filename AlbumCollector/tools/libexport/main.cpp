@@ -0,0 +1,194 @@
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImageReader>
+#include <QMutex>
+#include <QSemaphore>
+#include <QTextStream>
+#include <QThreadPool>
+#include "LibraryExport.h"
+#include "LibraryStore.h"
+
+namespace {
+
+QString safeFileName(const std::string& id)
+{
+    QString name = QString::fromStdString(id);
+    for (QChar& c : name) {
+        if (!c.isLetterOrNumber()) c = QLatin1Char('_');
+    }
+    return name;
+}
+
+// Scales a cover to fit size x size and writes it as JPEG. The decoder
+// does most of the downscaling, so large covers stay cheap.
+bool writeThumbnail(const QByteArray& encoded, int size, const QString& path)
+{
+    QByteArray data = encoded;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    const QSize original = reader.size();
+    if (original.isValid() && (original.width() > size || original.height() > size)) {
+        reader.setScaledSize(original.scaled(size, size, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) return false;
+    if (image.width() > size || image.height() > size) {
+        image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image.save(path, "JPG", 85);
+}
+
+// Records are formatted as they are read; nothing accumulates
+int exportText(LibraryStore::Reader& reader, const QString& path, bool csv)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return -1;
+    if (csv) file.write(LibraryExport::csvHeader());
+
+    int count = 0;
+    LibraryAlbum libAlbum(Album("", "", "", "", ""), QByteArray());
+    while (reader.next(libAlbum)) {
+        file.write(csv ? LibraryExport::csvRow(libAlbum) : LibraryExport::jsonLine(libAlbum));
+        ++count;
+    }
+    return file.error() == QFileDevice::NoError ? count : -1;
+}
+
+// index.html streams out while covers are scaled on every core. At most
+// two jobs per thread are queued, each holding one cover, so memory stays
+// flat however big the library is.
+int exportGallery(LibraryStore::Reader& reader, const QString& directory, int thumbSize)
+{
+    QDir dir(directory);
+    if (!dir.mkpath("covers")) return -1;
+    QFile file(dir.filePath("index.html"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return -1;
+
+    QTextStream html(&file);
+    html.setEncoding(QStringConverter::Utf8);
+    html << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>Album Collection</title>\n"
+         << "<style>body{font-family:sans-serif;margin:24px;background:#f4f4f4}"
+         << "main{display:grid;grid-template-columns:repeat(auto-fill,minmax(" << thumbSize << "px,1fr));gap:16px}"
+         << "figure{margin:0}img,.blank{width:100%;aspect-ratio:1;object-fit:cover;background:#ccc;display:block}"
+         << "figcaption{font-size:13px;margin-top:4px}small{color:#666}</style></head><body>\n"
+         << "<h1>Album Collection</h1>\n<main>\n";
+
+    QThreadPool pool;
+    QSemaphore queued(2 * pool.maxThreadCount());
+    QMutex failedLock;
+    QStringList failed;
+
+    int count = 0;
+    LibraryAlbum libAlbum(Album("", "", "", "", ""), QByteArray());
+    while (reader.next(libAlbum)) {
+        const Album& album = libAlbum.album;
+        const QString cover = "covers/" + safeFileName(album.id) + ".jpg";
+        QString year = QString::fromStdString(album.release_date).left(4);
+        QString caption = QString::fromStdString(album.name).toHtmlEscaped() + "<br><small>"
+            + QString::fromStdString(album.artist).toHtmlEscaped()
+            + (year.isEmpty() ? QString() : " · " + year)
+            + (album.rating > 0 ? QString(" · %1/10").arg(album.rating) : QString()) + "</small>";
+
+        if (libAlbum.imageData.isEmpty()) {
+            html << "<figure><div class=\"blank\"></div><figcaption>" << caption << "</figcaption></figure>\n";
+        } else {
+            // The markup is out before the cover is scaled, so a cover that
+            // fails to decode falls back to the blank tile in the browser
+            html << "<figure><img src=\"" << cover << "\" loading=\"lazy\" alt=\"\""
+                 << " onerror=\"this.outerHTML='&lt;div class=&quot;blank&quot;&gt;&lt;/div&gt;'\"><figcaption>"
+                 << caption << "</figcaption></figure>\n";
+            queued.acquire();
+            pool.start([&queued, &failed, &failedLock, encoded = libAlbum.imageData, thumbSize,
+                        path = dir.filePath(cover), id = QString::fromStdString(album.id)]() {
+                if (!writeThumbnail(encoded, thumbSize, path)) {
+                    QFile::remove(path);
+                    QMutexLocker locker(&failedLock);
+                    failed << id;
+                }
+                queued.release();
+            });
+        }
+        ++count;
+    }
+
+    html << "</main>\n</body></html>\n";
+    pool.waitForDone();
+    if (!failed.isEmpty()) {
+        failed.sort();
+        QTextStream(stderr) << failed.size() << " covers could not be decoded, shown blank: "
+                            << failed.join(", ") << Qt::endl;
+    }
+    html.flush();
+    return file.error() == QFileDevice::NoError ? count : -1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("libexport");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Exports an AlbumCollector library file.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("library", "Library file to read.");
+    parser.addPositionalArgument("output", "File to write, or directory for html.");
+
+    QCommandLineOption formatOption("format", "jsonl, csv or html (default: from the output name).", "format");
+    QCommandLineOption thumbOption("thumb-size", "Gallery thumbnail edge in pixels.", "px", "240");
+    parser.addOptions({formatOption, thumbOption});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    const QString output = arguments[1];
+    QString format = parser.value(formatOption).toLower();
+    if (format.isEmpty()) {
+        const QString suffix = QFileInfo(output).suffix().toLower();
+        format = suffix == "csv" ? "csv" : suffix == "jsonl" || suffix == "json" ? "jsonl" : "html";
+    }
+    if (format != "jsonl" && format != "csv" && format != "html") {
+        out << "Unknown format " << format << Qt::endl;
+        return 1;
+    }
+
+    LibraryStore::Reader reader(arguments[0]);
+    if (!reader.isOpen()) {
+        out << "Not a library file: " << arguments[0] << Qt::endl;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int count = format == "html"
+        ? exportGallery(reader, output, qMax(16, parser.value(thumbOption).toInt()))
+        : exportText(reader, output, format == "csv");
+    if (count < 0) {
+        out << "Failed to write " << output << Qt::endl;
+        return 1;
+    }
+    // Reader::next stops both at the end and at a damaged record
+    if (quint32(count) < reader.count()) {
+        out << "Library file is damaged: exported " << count << " of "
+            << reader.count() << " albums to " << output << Qt::endl;
+        return 1;
+    }
+
+    out << "Exported " << count << " albums to " << output
+        << " in " << timer.elapsed() << " ms" << Qt::endl;
+    return 0;
+}
@@ -0,0 +1,20 @@
+# Writes synthetic library.dat files of any size for scale testing:
+#   ./libgen --albums 50000 --image-size 60 large.dat
+#   ./AlbumCollector --scale-test large.dat
+
+QT       += core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = libgen
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../SyntheticCovers.h
+
+include(../../core/core.pri)
+
+INCLUDEPATH += ..
@@ -0,0 +1,71 @@
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QTextStream>
+#include "LibraryStore.h"
+#include "SyntheticCovers.h"
+#include "SyntheticLibrary.h"
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("libgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates a synthetic AlbumCollector library file.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Library file to write.");
+
+    QCommandLineOption albumsOption("albums", "Number of albums.", "n", "10000");
+    QCommandLineOption artistsOption("artists", "Number of distinct artists (default albums / 8).", "n", "0");
+    QCommandLineOption skewOption("skew", "Zipf exponent of albums per artist.", "s", "1.1");
+    QCommandLineOption imageSizeOption("image-size", "Cover edge in pixels, 0 for none.", "px", "60");
+    QCommandLineOption formatOption("image-format", "Cover encoding: PNG or JPG.", "format", "PNG");
+    QCommandLineOption distinctOption("distinct-images", "Distinct covers, reused round-robin.", "n", "256");
+    QCommandLineOption seedOption("seed", "Random seed.", "n", "42");
+    parser.addOptions({albumsOption, artistsOption, skewOption, imageSizeOption,
+                       formatOption, distinctOption, seedOption});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    SyntheticLibrary::Options options;
+    options.albumCount = parser.value(albumsOption).toInt();
+    options.artistCount = parser.value(artistsOption).toInt();
+    options.artistSkew = parser.value(skewOption).toDouble();
+    options.seed = parser.value(seedOption).toUInt();
+
+    // Encoding every cover would dominate generation time; a pool of
+    // distinct ones keeps the file size realistic without that cost
+    const int imageSize = parser.value(imageSizeOption).toInt();
+    const QByteArray format = parser.value(formatOption).toLatin1();
+    QVector<QByteArray> covers;
+    if (imageSize > 0) {
+        const int distinct = qMax(1, parser.value(distinctOption).toInt());
+        for (int i = 0; i < distinct; ++i) {
+            covers.append(encodeImage(makeCoverImage(imageSize, i), format.constData(), 85));
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<LibraryAlbum> albums = SyntheticLibrary::generate(options, [&covers](int index) {
+        return covers.isEmpty() ? QByteArray() : covers[index % covers.size()];
+    });
+
+    const QString path = parser.positionalArguments().first();
+    if (!LibraryStore(path).save(albums)) {
+        out << "Failed to write " << path << Qt::endl;
+        return 1;
+    }
+
+    out << "Wrote " << albums.size() << " albums to " << path
+        << " in " << timer.elapsed() << " ms" << Qt::endl;
+    return 0;
+}
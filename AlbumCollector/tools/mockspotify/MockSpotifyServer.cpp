@@ -0,0 +1,369 @@
+#include "MockSpotifyServer.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrlQuery>
+#include <zlib.h>
+#include "SyntheticCovers.h"
+
+namespace {
+
+// Bandwidth pacing granularity
+const int PaceIntervalMs = 20;
+const int MaxHeaderBytes = 64 * 1024;
+
+QJsonObject readJson(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Cannot open %1").arg(path);
+        return QJsonObject();
+    }
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject()) {
+        *error = QString("%1: %2").arg(path, parseError.errorString());
+        return QJsonObject();
+    }
+    return document.object();
+}
+
+// Stable 22 character base62 id per album index, like the real ones
+QString mockAlbumId(int index)
+{
+    static const char alphabet[] =
+        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    QString id(22, QChar('0'));
+    quint64 value = quint64(index) * 2654435761u + 1;
+    for (int i = 21; i >= 0 && value; --i) {
+        id[i] = QChar(alphabet[value % 62]);
+        value /= 62;
+    }
+    return id;
+}
+
+// gzip member (RFC 1952) at the default level, as a web server would send
+QByteArray gzipEncode(const QByteArray& data)
+{
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return QByteArray();
+    }
+    QByteArray out(int(deflateBound(&stream, uLong(data.size()))) + 32, Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = uInt(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = uInt(out.size());
+    const int result = deflate(&stream, Z_FINISH);
+    out.resize(int(stream.total_out));
+    deflateEnd(&stream);
+    return result == Z_STREAM_END ? out : QByteArray();
+}
+
+bool acceptsGzipEncoding(const QByteArray& acceptEncoding)
+{
+    for (const QByteArray& entry : acceptEncoding.split(',')) {
+        const QList<QByteArray> parts = entry.split(';');
+        if (parts.first().trimmed().toLower() != "gzip") continue;
+        return parts.size() < 2 || parts[1].trimmed() != "q=0";
+    }
+    return false;
+}
+
+} // namespace
+
+MockSpotifyServer::MockSpotifyServer(const Options& options, QObject* parent)
+    : QObject(parent)
+    , options(options)
+    , random(options.seed)
+{
+    connect(&server, &QTcpServer::newConnection, this, &MockSpotifyServer::onNewConnection);
+}
+
+bool MockSpotifyServer::loadFixtures(const QString& dataDir, QString* error)
+{
+    error->clear();
+    searchItems = readJson(dataDir + "/search_albums.json", error)
+                      .value("albums").toObject().value("items").toArray();
+    if (!error->isEmpty()) return false;
+    fullAlbums = readJson(dataDir + "/several_albums.json", error).value("albums").toArray();
+    if (!error->isEmpty()) return false;
+    if (searchItems.isEmpty() || fullAlbums.isEmpty()) {
+        *error = "Fixtures contain no albums";
+        return false;
+    }
+    return true;
+}
+
+bool MockSpotifyServer::listen(quint16 port)
+{
+    return server.listen(QHostAddress::LocalHost, port);
+}
+
+void MockSpotifyServer::onNewConnection()
+{
+    while (QTcpSocket* socket = server.nextPendingConnection()) {
+        connections.insert(socket, Connection());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            connections[socket].buffer += socket->readAll();
+            processRequests(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+// Handles one complete request at a time; anything pipelined behind it
+// waits until the delayed response has gone out
+void MockSpotifyServer::processRequests(QTcpSocket* socket)
+{
+    Connection& connection = connections[socket];
+    if (connection.busy) return;
+
+    const int headerEnd = connection.buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (connection.buffer.size() > MaxHeaderBytes) socket->disconnectFromHost();
+        return;
+    }
+
+    QList<QByteArray> lines = connection.buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.takeFirst().trimmed().split(' ');
+    if (requestLine.size() < 3) {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    qint64 contentLength = 0;
+    bool keepAlive = requestLine[2] != "HTTP/1.0";
+    bool acceptsGzip = false;
+    for (const QByteArray& line : lines) {
+        const int colon = line.indexOf(':');
+        if (colon < 0) continue;
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        if (name == "content-length") contentLength = value.toLongLong();
+        else if (name == "connection") keepAlive = value.toLower() != "close";
+        else if (name == "accept-encoding") acceptsGzip = acceptsGzipEncoding(value);
+    }
+    if (connection.buffer.size() < headerEnd + 4 + contentLength) return;
+    connection.buffer.remove(0, headerEnd + 4 + contentLength);
+
+    const QByteArray method = requestLine[0];
+    const QUrl url(QString::fromLatin1(requestLine[1]));
+    Response response = route(method, url);
+
+    // Injected failures only hit the API, never the token or images, so a
+    // run measures the client's retry path rather than its error handling
+    if (url.path().startsWith("/v1/") && random.generateDouble() < options.errorRate) {
+        response = errorResponse(options.errorStatus, "Injected failure");
+        if (options.errorStatus == 429) {
+            response.headers.append({"Retry-After", QByteArray::number(options.retryAfterSeconds)});
+        }
+    }
+
+    const int delay = options.latencyMs +
+        (options.jitterMs > 0 ? int(random.bounded(options.jitterMs + 1)) : 0);
+    connection.busy = true;
+    QPointer<QTcpSocket> guard(socket);
+    QTimer::singleShot(delay, this, [this, guard, response, keepAlive, acceptsGzip]() {
+        if (!guard) return;
+        send(guard, response, keepAlive, acceptsGzip && options.gzip);
+    });
+}
+
+MockSpotifyServer::Response MockSpotifyServer::route(const QByteArray& method, const QUrl& url)
+{
+    const QString path = url.path();
+    if (method == "POST" && path == "/api/token") {
+        QJsonObject token;
+        token["access_token"] = "mock-access-token";
+        token["token_type"] = "Bearer";
+        token["expires_in"] = 3600;
+        return jsonResponse(token);
+    }
+    if (method != "GET") return errorResponse(405, "Method not allowed");
+    if (path == "/v1/search") return searchResponse(url);
+    if (path == "/v1/albums") return albumsResponse(url);
+    if (path.startsWith("/image/")) return imageResponse(path);
+    return errorResponse(404, "Not found");
+}
+
+MockSpotifyServer::Response MockSpotifyServer::searchResponse(const QUrl& url)
+{
+    const QUrlQuery query(url);
+    if (query.queryItemValue("q").isEmpty()) return errorResponse(400, "No search query");
+    const int offset = qMax(0, query.queryItemValue("offset").toInt());
+    int limit = query.queryItemValue("limit").toInt();
+    if (limit <= 0) limit = 20;
+    limit = qMin(limit, 50);
+
+    QJsonArray items;
+    for (int i = offset; i < qMin(offset + limit, options.searchTotal); ++i) {
+        QJsonObject album = searchItems.at(i % searchItems.size()).toObject();
+        items.append(rewriteAlbum(album, mockAlbumId(i), i));
+    }
+
+    QJsonObject page;
+    page["href"] = url.toString();
+    page["items"] = items;
+    page["limit"] = limit;
+    page["offset"] = offset;
+    page["total"] = options.searchTotal;
+    if (offset + limit < options.searchTotal) {
+        QUrl next(url);
+        QUrlQuery nextQuery(query);
+        nextQuery.removeQueryItem("offset");
+        nextQuery.addQueryItem("offset", QString::number(offset + limit));
+        next.setQuery(nextQuery);
+        page["next"] = next.toString();
+    } else {
+        page["next"] = QJsonValue::Null;
+    }
+    page["previous"] = QJsonValue::Null;
+
+    QJsonObject root;
+    root["albums"] = page;
+    return jsonResponse(root);
+}
+
+MockSpotifyServer::Response MockSpotifyServer::albumsResponse(const QUrl& url)
+{
+    const QStringList ids = QUrlQuery(url).queryItemValue("ids").split(',', Qt::SkipEmptyParts);
+    if (ids.isEmpty() || ids.size() > 20) return errorResponse(400, "Expected 1 to 20 ids");
+
+    QJsonArray albums;
+    for (const QString& id : ids) {
+        const int seed = int(qHash(id, options.seed) & 0xffff);
+        QJsonObject album = fullAlbums.at(seed % fullAlbums.size()).toObject();
+        albums.append(rewriteAlbum(album, id, seed));
+    }
+    QJsonObject root;
+    root["albums"] = albums;
+    return jsonResponse(root);
+}
+
+// /image/<seed>/<size>: a synthetic JPEG cover, encoded once per pair
+MockSpotifyServer::Response MockSpotifyServer::imageResponse(const QString& path)
+{
+    const QStringList parts = path.split('/', Qt::SkipEmptyParts);
+    const int seed = parts.value(1).toInt();
+    const int size = parts.value(2).toInt();
+    if (parts.size() != 3 || size < 8 || size > 2048) return errorResponse(404, "No such image");
+
+    const QString key = parts[1] + '/' + parts[2];
+    auto cached = imageCache.find(key);
+    if (cached == imageCache.end()) {
+        cached = imageCache.insert(key, encodeImage(makeCoverImage(size, seed), "JPG", 85));
+    }
+    Response response;
+    response.contentType = "image/jpeg";
+    response.body = *cached;
+    return response;
+}
+
+QJsonObject MockSpotifyServer::rewriteAlbum(QJsonObject album, const QString& id, int seed) const
+{
+    const QString base = QString("http://127.0.0.1:%1").arg(server.serverPort());
+    album["id"] = id;
+    album["uri"] = "spotify:album:" + id;
+    album["href"] = base + "/v1/albums/" + id;
+
+    QJsonArray images;
+    for (const QJsonValue& value : album.value("images").toArray()) {
+        QJsonObject image = value.toObject();
+        image["url"] = QString("%1/image/%2/%3").arg(base).arg(seed).arg(image.value("width").toInt());
+        images.append(image);
+    }
+    album["images"] = images;
+    return album;
+}
+
+// Compressed on the way out, after the delay, so the encoding cost lands
+// in the measured response time like it would on a real server
+void MockSpotifyServer::send(QTcpSocket* socket, const Response& response, bool keepAlive, bool acceptsGzip)
+{
+    QByteArray body = response.body;
+    const bool compress = acceptsGzip && response.contentType == "application/json";
+    if (compress) body = gzipEncode(body);
+
+    QByteArray data = "HTTP/1.1 " + QByteArray::number(response.status) + ' ' +
+                      reasonPhrase(response.status) + "\r\n";
+    data += "Content-Type: " + response.contentType + "\r\n";
+    data += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    if (compress) data += "Content-Encoding: gzip\r\n";
+    data += "Vary: Accept-Encoding\r\n";
+    for (const auto& header : response.headers) {
+        data += header.first + ": " + header.second + "\r\n";
+    }
+    data += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    data += "\r\n";
+    data += body;
+
+    if (!keepAlive) {
+        connect(socket, &QTcpSocket::bytesWritten, socket, [socket]() {
+            if (socket->bytesToWrite() == 0) socket->disconnectFromHost();
+        });
+    }
+    writePaced(socket, data);
+}
+
+// Writes data no faster than the bandwidth cap, then frees the connection
+// for the next request
+void MockSpotifyServer::writePaced(QTcpSocket* socket, QByteArray data)
+{
+    const qint64 chunk = options.bandwidthKBps > 0
+        ? qMax<qint64>(1, qint64(options.bandwidthKBps) * 1024 * PaceIntervalMs / 1000)
+        : data.size();
+    socket->write(data.left(chunk));
+    data.remove(0, qMin<qint64>(chunk, data.size()));
+
+    if (!data.isEmpty()) {
+        QPointer<QTcpSocket> guard(socket);
+        QTimer::singleShot(PaceIntervalMs, this, [this, guard, data]() {
+            if (guard) writePaced(guard, data);
+        });
+        return;
+    }
+    auto it = connections.find(socket);
+    if (it == connections.end()) return;
+    it->busy = false;
+    processRequests(socket);
+}
+
+MockSpotifyServer::Response MockSpotifyServer::jsonResponse(const QJsonObject& object)
+{
+    Response response;
+    response.body = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    return response;
+}
+
+MockSpotifyServer::Response MockSpotifyServer::errorResponse(int status, const QByteArray& message)
+{
+    QJsonObject error;
+    error["status"] = status;
+    error["message"] = QString::fromLatin1(message);
+    QJsonObject root;
+    root["error"] = error;
+    Response response = jsonResponse(root);
+    response.status = status;
+    return response;
+}
+
+QByteArray MockSpotifyServer::reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+    }
+}
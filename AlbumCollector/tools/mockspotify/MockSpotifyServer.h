@@ -0,0 +1,81 @@
+#ifndef MOCKSPOTIFYSERVER_H
+#define MOCKSPOTIFYSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+
+// Minimal HTTP/1.1 server answering the three endpoints SpotifyClient uses
+// (token, search, several albums) plus cover images. JSON is gzipped for
+// clients that accept it, as the real API does; covers are sent as they
+// are. Responses are built from the recorded fixtures in bench/data,
+// rewritten so every page has distinct album ids and every image URL
+// points back at this server.
+class MockSpotifyServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int latencyMs = 0;          // added before each response starts
+        int jitterMs = 0;           // uniform extra delay in [0, jitter]
+        int bandwidthKBps = 0;      // per-connection cap, 0 for unlimited
+        double errorRate = 0.0;     // share of API requests answered with errorStatus
+        int errorStatus = 429;
+        int retryAfterSeconds = 1;  // sent with 429 responses
+        int searchTotal = 200;      // "total" reported by search
+        bool gzip = true;           // honour Accept-Encoding: gzip for JSON
+        quint32 seed = 42;
+    };
+
+    MockSpotifyServer(const Options& options, QObject* parent = nullptr);
+
+    // Reads search_albums.json and several_albums.json from dataDir
+    bool loadFixtures(const QString& dataDir, QString* error);
+    bool listen(quint16 port);
+    quint16 port() const { return server.serverPort(); }
+
+private:
+    struct Response {
+        int status = 200;
+        QByteArray contentType = "application/json";
+        QByteArray body;
+        QList<QPair<QByteArray, QByteArray>> headers;
+    };
+
+    struct Connection {
+        QByteArray buffer;
+        bool busy = false;
+    };
+
+    void onNewConnection();
+    void processRequests(QTcpSocket* socket);
+    Response route(const QByteArray& method, const QUrl& url);
+    Response searchResponse(const QUrl& url);
+    Response albumsResponse(const QUrl& url);
+    Response imageResponse(const QString& path);
+    QJsonObject rewriteAlbum(QJsonObject album, const QString& id, int seed) const;
+    void send(QTcpSocket* socket, const Response& response, bool keepAlive, bool acceptsGzip);
+    void writePaced(QTcpSocket* socket, QByteArray data);
+
+    static Response jsonResponse(const QJsonObject& object);
+    static Response errorResponse(int status, const QByteArray& message);
+    static QByteArray reasonPhrase(int status);
+
+    Options options;
+    QTcpServer server;
+    QRandomGenerator random;
+    QJsonArray searchItems;
+    QJsonArray fullAlbums;
+    QHash<QTcpSocket*, Connection> connections;
+    QHash<QString, QByteArray> imageCache;
+};
+
+#endif // MOCKSPOTIFYSERVER_H
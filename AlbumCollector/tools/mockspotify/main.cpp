@@ -0,0 +1,63 @@
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QTextStream>
+#include "MockSpotifyServer.h"
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mockspotify");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serves a mock Spotify Web API with configurable network conditions.");
+    parser.addHelpOption();
+
+    QCommandLineOption portOption("port", "Port to listen on (127.0.0.1 only).", "port", "8099");
+    QCommandLineOption dataOption("data", "Directory with the JSON fixtures.", "dir", MOCK_DATA_DIR);
+    QCommandLineOption latencyOption("latency", "Delay before each response.", "ms", "0");
+    QCommandLineOption jitterOption("jitter", "Extra random delay up to this much.", "ms", "0");
+    QCommandLineOption bandwidthOption("bandwidth", "Per-connection cap, 0 for unlimited.", "KB/s", "0");
+    QCommandLineOption errorRateOption("error-rate", "Share of API requests that fail, 0 to 1.", "rate", "0");
+    QCommandLineOption errorStatusOption("error-status", "HTTP status for injected failures.", "status", "429");
+    QCommandLineOption retryAfterOption("retry-after", "Retry-After sent with 429.", "seconds", "1");
+    QCommandLineOption totalOption("search-total", "Total results reported per search.", "n", "200");
+    QCommandLineOption seedOption("seed", "Random seed for jitter and failures.", "n", "42");
+    QCommandLineOption noGzipOption("no-gzip", "Send JSON uncompressed even when gzip is accepted.");
+    parser.addOptions({portOption, dataOption, latencyOption, jitterOption, bandwidthOption,
+                       errorRateOption, errorStatusOption, retryAfterOption, totalOption, seedOption,
+                       noGzipOption});
+    parser.process(app);
+
+    MockSpotifyServer::Options options;
+    options.latencyMs = parser.value(latencyOption).toInt();
+    options.jitterMs = parser.value(jitterOption).toInt();
+    options.bandwidthKBps = parser.value(bandwidthOption).toInt();
+    options.errorRate = parser.value(errorRateOption).toDouble();
+    options.errorStatus = parser.value(errorStatusOption).toInt();
+    options.retryAfterSeconds = parser.value(retryAfterOption).toInt();
+    options.searchTotal = parser.value(totalOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+    options.gzip = !parser.isSet(noGzipOption);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    MockSpotifyServer server(options);
+    QString error;
+    if (!server.loadFixtures(parser.value(dataOption), &error)) {
+        err << error << "\n";
+        return 1;
+    }
+    if (!server.listen(parser.value(portOption).toUShort())) {
+        err << "Cannot listen on port " << parser.value(portOption) << "\n";
+        return 1;
+    }
+
+    out << "Mock Spotify API on http://127.0.0.1:" << server.port() << "\n"
+        << "  ALBUMCOLLECTOR_API_URL=http://127.0.0.1:" << server.port()
+        << " ALBUMCOLLECTOR_ACCOUNTS_URL=http://127.0.0.1:" << server.port() << "\n";
+    out.flush();
+    return app.exec();
+}
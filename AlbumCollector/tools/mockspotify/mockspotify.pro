@@ -0,0 +1,25 @@
+# Local stand-in for the Spotify Web API with controllable network
+# conditions, so search, enrichment and cover downloads can be measured
+# reproducibly:
+#   ./mockspotify --port 8099 --latency 80 --jitter 40 --bandwidth 200
+#   ./AlbumCollector --api-url http://127.0.0.1:8099 --accounts-url http://127.0.0.1:8099
+
+QT       += core gui network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = mockspotify
+
+SOURCES += \
+    main.cpp \
+    MockSpotifyServer.cpp
+
+HEADERS += \
+    MockSpotifyServer.h \
+    ../SyntheticCovers.h
+
+DEFINES += MOCK_DATA_DIR=\\\"$$PWD/../../bench/data\\\"
+
+INCLUDEPATH += ..
+LIBS += -lz